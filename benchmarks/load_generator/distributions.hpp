@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace load_generator {
+
+// Samples ranks in [0, n) with P(k) ~ 1 / (k + 1)^s. The CDF is precomputed
+// once, so sampling is a binary search and the object is safe to share
+// between threads as long as each thread brings its own engine.
+class ZipfDistribution
+{
+public:
+    ZipfDistribution(std::uint64_t n, double s) : cdf_(n)
+    {
+        double sum = 0.0;
+        for (std::uint64_t k = 0; k < n; ++k)
+        {
+            sum += 1.0 / std::pow(static_cast<double>(k + 1), s);
+            cdf_[k] = sum;
+        }
+        for (auto& value : cdf_)
+            value /= sum;
+    }
+
+    template <typename Engine>
+    std::uint64_t operator()(Engine& engine) const
+    {
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(engine);
+        const auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+        return std::min<std::uint64_t>(it - cdf_.begin(), cdf_.size() - 1);
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+// Library sizes follow a log-normal distribution: most users own a handful
+// of games, a long tail owns thousands.
+class LibrarySizeDistribution
+{
+public:
+    LibrarySizeDistribution(double median, double sigma, std::int32_t max_size)
+        : distribution_(std::log(std::max(median, 1.0)), sigma),
+          max_size_(max_size)
+    {}
+
+    template <typename Engine>
+    std::int32_t operator()(Engine& engine)
+    {
+        const auto size = static_cast<std::int64_t>(distribution_(engine));
+        return static_cast<std::int32_t>(
+            std::clamp<std::int64_t>(size, 1, max_size_));
+    }
+
+private:
+    std::lognormal_distribution<double> distribution_;
+    std::int32_t max_size_;
+};
+
+// Deterministic ids keep reruns idempotent: the same user/game pair always
+// hits the same primary key, so prefill can be repeated safely.
+inline std::string MakeUuid(std::uint32_t kind, std::uint64_t high,
+                            std::uint64_t low)
+{
+    char buffer[37];
+    std::snprintf(buffer, sizeof(buffer), "%08x-%04x-4%03x-8%03x-%012llx",
+                  kind, static_cast<unsigned>((high >> 16) & 0xffff),
+                  static_cast<unsigned>(high & 0xfff),
+                  static_cast<unsigned>((low >> 48) & 0xfff),
+                  static_cast<unsigned long long>(low & 0xffffffffffffULL));
+    return buffer;
+}
+
+inline std::string UserUuid(std::uint64_t user_index)
+{
+    return MakeUuid(0x10adu, 0, user_index);
+}
+
+inline std::string GameUuid(std::uint64_t game_index)
+{
+    return MakeUuid(0x6a3eu, 0, game_index);
+}
+
+// Percentile over a sorted sample using the nearest-rank method.
+inline std::int64_t Percentile(const std::vector<std::int64_t>& sorted,
+                               double quantile)
+{
+    if (sorted.empty())
+        return 0;
+
+    const auto rank = static_cast<std::size_t>(
+        std::ceil(quantile * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+} // namespace load_generator
@@ -0,0 +1,557 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <grpcpp/grpcpp.h>
+#include <nlohmann/json.hpp>
+
+#include <library/library.grpc.pb.h>
+
+#include "distributions.hpp"
+
+namespace po = boost::program_options;
+
+namespace load_generator {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Operation : std::size_t
+{
+    kUpdateLibraryEntry = 0,
+    kGetUserLibrary = 1,
+    kGetLibraryStats = 2,
+};
+
+constexpr std::size_t kOperationCount = 3;
+constexpr const char* kOperationNames[kOperationCount] = {
+    "UpdateLibraryEntry", "GetUserLibrary", "GetLibraryStats"
+};
+
+struct Config
+{
+    std::string endpoint;
+    std::string output;
+    std::uint32_t concurrency{};
+    std::uint32_t duration_s{};
+    std::uint32_t warmup_s{};
+    std::uint32_t timeout_ms{};
+    // Total requests per second across workers, 0 runs closed loop.
+    double rate{};
+    std::uint64_t users{};
+    double zipf_s{};
+    double library_median{};
+    double library_sigma{};
+    std::int32_t library_max{};
+    std::int32_t page_size{};
+    std::vector<double> mix;
+    bool prefill{};
+    std::uint64_t seed{};
+};
+
+struct OperationStats
+{
+    std::uint64_t errors = 0;
+    std::vector<std::int64_t> latencies_us;
+};
+
+struct WorkerStats
+{
+    OperationStats operations[kOperationCount];
+    // Open loop only: requests issued after their scheduled start because
+    // the worker was still busy with an earlier call.
+    std::uint64_t late_starts = 0;
+};
+
+class Workload
+{
+public:
+    explicit Workload(const Config& config)
+        : users_(config.users, config.zipf_s),
+          library_sizes_(config.users)
+    {
+        std::mt19937_64 engine(config.seed);
+        LibrarySizeDistribution sizes(config.library_median,
+                                      config.library_sigma,
+                                      config.library_max);
+        for (auto& size : library_sizes_)
+            size = sizes(engine);
+    }
+
+    std::uint64_t PickUser(std::mt19937_64& engine) const
+    {
+        return users_(engine);
+    }
+
+    std::int32_t LibrarySize(std::uint64_t user) const
+    {
+        return library_sizes_[user];
+    }
+
+    std::uint64_t TotalEntries() const
+    {
+        std::uint64_t total = 0;
+        for (const auto size : library_sizes_)
+            total += size;
+        return total;
+    }
+
+private:
+    ZipfDistribution users_;
+    std::vector<std::int32_t> library_sizes_;
+};
+
+::library::GameStatus RandomStatus(std::mt19937_64& engine)
+{
+    // Skip GAME_STATUS_UNSPECIFIED: real clients always send a status.
+    return static_cast<::library::GameStatus>(
+        std::uniform_int_distribution<int>(1, 5)(engine));
+}
+
+class Worker
+{
+public:
+    Worker(const Config& config, const Workload& workload,
+           std::shared_ptr<grpc::Channel> channel, std::uint64_t seed)
+        : config_(config), workload_(workload),
+          stub_(::library::LibraryService::NewStub(std::move(channel))),
+          engine_(seed), mix_(config.mix.begin(), config.mix.end())
+    {}
+
+    void Prefill(std::uint64_t first_user, std::uint64_t step)
+    {
+        for (auto user = first_user; user < config_.users; user += step)
+        {
+            for (std::int32_t game = 0; game < workload_.LibrarySize(user);
+                 ++game)
+            {
+                ::library::UpdateLibraryEntryRequest request;
+                request.set_user_id(UserUuid(user));
+                request.set_game_id(GameUuid(game));
+                request.set_status(RandomStatus(engine_));
+
+                ::library::UpdateLibraryEntryResponse response;
+                auto context = MakeContext();
+                if (!stub_->UpdateLibraryEntry(context.get(), request,
+                                               &response)
+                         .ok())
+                    ++prefill_errors_;
+            }
+        }
+    }
+
+    // With a zero interval the worker runs closed loop: the next call
+    // starts when the previous one returns, and latency is service time.
+    // Otherwise calls are scheduled every interval starting at first_start,
+    // and latency is measured from the scheduled start. A slow call then
+    // also counts the delay it causes for the calls queued behind it,
+    // instead of hiding it (coordinated omission).
+    void Run(const std::atomic<bool>& measuring, const std::atomic<bool>& stop,
+             Clock::duration interval, Clock::time_point first_start)
+    {
+        const bool open_loop = interval > Clock::duration::zero();
+        auto scheduled = first_start;
+
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            if (open_loop && !SleepUntil(scheduled, stop))
+                break;
+
+            const auto operation = static_cast<Operation>(mix_(engine_));
+            const auto started = open_loop ? scheduled : Clock::now();
+            const bool late =
+                open_loop && Clock::now() - scheduled > kLateStartTolerance;
+            const bool ok = Execute(operation);
+            const auto elapsed = std::chrono::duration_cast<
+                std::chrono::microseconds>(Clock::now() - started);
+            scheduled += interval;
+
+            if (!measuring.load(std::memory_order_relaxed))
+                continue;
+
+            auto& stats =
+                stats_.operations[static_cast<std::size_t>(operation)];
+            stats.latencies_us.push_back(elapsed.count());
+            if (!ok)
+                ++stats.errors;
+            if (late)
+                ++stats_.late_starts;
+        }
+    }
+
+    WorkerStats& Stats() { return stats_; }
+    std::uint64_t PrefillErrors() const { return prefill_errors_; }
+
+private:
+    static constexpr auto kLateStartTolerance = std::chrono::milliseconds(1);
+
+    // Sleeps in short steps so that a low rate does not delay shutdown.
+    // Returns false when stopped first.
+    static bool SleepUntil(Clock::time_point deadline,
+                           const std::atomic<bool>& stop)
+    {
+        while (Clock::now() < deadline)
+        {
+            if (stop.load(std::memory_order_relaxed))
+                return false;
+
+            std::this_thread::sleep_until(std::min(
+                deadline, Clock::now() + std::chrono::milliseconds(100)));
+        }
+
+        return true;
+    }
+
+    std::unique_ptr<grpc::ClientContext> MakeContext() const
+    {
+        auto context = std::make_unique<grpc::ClientContext>();
+        context->set_deadline(std::chrono::system_clock::now() +
+                              std::chrono::milliseconds(config_.timeout_ms));
+        return context;
+    }
+
+    bool Execute(Operation operation)
+    {
+        const auto user = workload_.PickUser(engine_);
+        const auto size = workload_.LibrarySize(user);
+        auto context = MakeContext();
+
+        switch (operation)
+        {
+        case Operation::kUpdateLibraryEntry:
+        {
+            // ~10% of writes add a game the user did not own yet.
+            const auto game = std::uniform_int_distribution<std::int32_t>(
+                0, size + size / 10)(engine_);
+
+            ::library::UpdateLibraryEntryRequest request;
+            request.set_user_id(UserUuid(user));
+            request.set_game_id(GameUuid(game));
+            request.set_status(RandomStatus(engine_));
+
+            ::library::UpdateLibraryEntryResponse response;
+            return stub_->UpdateLibraryEntry(context.get(), request, &response)
+                .ok();
+        }
+        case Operation::kGetUserLibrary:
+        {
+            const auto pages = std::max(1, size / config_.page_size);
+            const auto page =
+                std::uniform_int_distribution<std::int32_t>(0, pages - 1)(
+                    engine_);
+
+            ::library::GetUserLibraryRequest request;
+            request.set_user_id(UserUuid(user));
+            request.set_limit(config_.page_size);
+            request.set_offset(page * config_.page_size);
+
+            ::library::GetUserLibraryResponse response;
+            return stub_->GetUserLibrary(context.get(), request, &response)
+                .ok();
+        }
+        case Operation::kGetLibraryStats:
+        {
+            ::library::GetLibraryStatsRequest request;
+            request.set_user_id(UserUuid(user));
+
+            ::library::GetLibraryStatsResponse response;
+            return stub_->GetLibraryStats(context.get(), request, &response)
+                .ok();
+        }
+        }
+
+        return false;
+    }
+
+    const Config& config_;
+    const Workload& workload_;
+    std::unique_ptr<::library::LibraryService::Stub> stub_;
+    std::mt19937_64 engine_;
+    std::discrete_distribution<std::size_t> mix_;
+    WorkerStats stats_;
+    std::uint64_t prefill_errors_ = 0;
+};
+
+nlohmann::json Summarize(std::vector<std::int64_t>& latencies_us,
+                         std::uint64_t errors, double duration_s)
+{
+    std::sort(latencies_us.begin(), latencies_us.end());
+
+    std::int64_t sum = 0;
+    for (const auto latency : latencies_us)
+        sum += latency;
+
+    const auto requests = latencies_us.size();
+    return {
+        { "requests", requests },
+        { "errors", errors },
+        { "throughput_rps", requests / duration_s },
+        { "latency_us",
+          {
+              { "mean", requests ? static_cast<double>(sum) / requests : 0.0 },
+              { "p50", Percentile(latencies_us, 0.50) },
+              { "p99", Percentile(latencies_us, 0.99) },
+              { "p999", Percentile(latencies_us, 0.999) },
+              { "max", latencies_us.empty() ? 0 : latencies_us.back() },
+          } },
+    };
+}
+
+nlohmann::json BuildReport(const Config& config,
+                           std::vector<std::unique_ptr<Worker>>& workers,
+                           std::uint64_t prefill_errors, double duration_s)
+{
+    nlohmann::json operations = nlohmann::json::object();
+    std::vector<std::int64_t> total_latencies;
+    std::uint64_t total_errors = 0;
+    std::uint64_t late_starts = 0;
+    for (auto& worker : workers)
+        late_starts += worker->Stats().late_starts;
+
+    for (std::size_t i = 0; i < kOperationCount; ++i)
+    {
+        std::vector<std::int64_t> latencies;
+        std::uint64_t errors = 0;
+        for (auto& worker : workers)
+        {
+            auto& stats = worker->Stats().operations[i];
+            latencies.insert(latencies.end(), stats.latencies_us.begin(),
+                             stats.latencies_us.end());
+            errors += stats.errors;
+        }
+
+        total_latencies.insert(total_latencies.end(), latencies.begin(),
+                               latencies.end());
+        total_errors += errors;
+        operations[kOperationNames[i]] =
+            Summarize(latencies, errors, duration_s);
+    }
+
+    return {
+        { "config",
+          {
+              { "endpoint", config.endpoint },
+              { "concurrency", config.concurrency },
+              { "mode", config.rate > 0 ? "open-loop" : "closed-loop" },
+              { "rate", config.rate },
+              { "duration_s", config.duration_s },
+              { "warmup_s", config.warmup_s },
+              { "users", config.users },
+              { "zipf_s", config.zipf_s },
+              { "library_median", config.library_median },
+              { "library_sigma", config.library_sigma },
+              { "library_max", config.library_max },
+              { "page_size", config.page_size },
+              { "mix", config.mix },
+              { "seed", config.seed },
+          } },
+        { "prefill_errors", prefill_errors },
+        { "late_starts", late_starts },
+        { "measured_duration_s", duration_s },
+        { "total", Summarize(total_latencies, total_errors, duration_s) },
+        { "operations", operations },
+    };
+}
+
+int Run(const Config& config)
+{
+    Workload workload(config);
+
+    grpc::ChannelArguments channel_args;
+    // One channel per worker, otherwise every worker multiplexes over a
+    // single HTTP/2 connection and the client becomes the bottleneck.
+    channel_args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (std::uint32_t i = 0; i < config.concurrency; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(
+            config, workload,
+            grpc::CreateCustomChannel(config.endpoint,
+                                      grpc::InsecureChannelCredentials(),
+                                      channel_args),
+            config.seed + i + 1));
+    }
+
+    std::uint64_t prefill_errors = 0;
+    if (config.prefill)
+    {
+        std::cerr << "Prefilling " << workload.TotalEntries()
+                  << " library entries for " << config.users << " users\n";
+
+        std::vector<std::thread> threads;
+        for (std::uint32_t i = 0; i < config.concurrency; ++i)
+            threads.emplace_back(
+                [&, i] { workers[i]->Prefill(i, config.concurrency); });
+        for (auto& thread : threads)
+            thread.join();
+
+        for (const auto& worker : workers)
+            prefill_errors += worker->PrefillErrors();
+    }
+
+    std::atomic<bool> measuring{ false };
+    std::atomic<bool> stop{ false };
+
+    // Each worker owns rate / concurrency of the arrivals; phases are
+    // staggered so the aggregate arrivals are evenly spaced.
+    Clock::duration interval = Clock::duration::zero();
+    if (config.rate > 0)
+        interval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(config.concurrency / config.rate));
+
+    const auto first_start = Clock::now();
+    std::vector<std::thread> threads;
+    for (std::uint32_t i = 0; i < config.concurrency; ++i)
+        threads.emplace_back([&, i, w = workers[i].get()] {
+            w->Run(measuring, stop, interval,
+                   first_start + interval * i / config.concurrency);
+        });
+
+    std::this_thread::sleep_for(std::chrono::seconds(config.warmup_s));
+    measuring = true;
+    const auto started = Clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(config.duration_s));
+    measuring = false;
+    const auto measured =
+        std::chrono::duration<double>(Clock::now() - started).count();
+    stop = true;
+
+    for (auto& thread : threads)
+        thread.join();
+
+    const auto report =
+        BuildReport(config, workers, prefill_errors, measured).dump(2);
+    if (config.output.empty() || config.output == "-")
+    {
+        std::cout << report << '\n';
+    }
+    else
+    {
+        std::ofstream(config.output) << report << '\n';
+    }
+
+    return 0;
+}
+
+} // namespace
+
+// Parses "a:b:c" weights, one per operation.
+std::optional<std::vector<double>> ParseMix(const std::string& mix)
+{
+    std::vector<double> weights;
+    double sum = 0.0;
+
+    std::stringstream mix_stream(mix);
+    for (std::string weight; std::getline(mix_stream, weight, ':');)
+    {
+        char* end = nullptr;
+        const double value = std::strtod(weight.c_str(), &end);
+        if (weight.empty() || end != weight.c_str() + weight.size() ||
+            !std::isfinite(value) || value < 0)
+            return std::nullopt;
+
+        weights.push_back(value);
+        sum += value;
+    }
+
+    if (weights.size() != kOperationCount || sum <= 0)
+        return std::nullopt;
+
+    return weights;
+}
+
+} // namespace load_generator
+
+int main(int argc, char* argv[])
+{
+    load_generator::Config config;
+    std::string mix;
+
+    po::options_description desc("library-service load generator");
+    const auto usage_error = [&desc](const std::string& message) {
+        std::cerr << message << '\n' << desc << '\n';
+        return 1;
+    };
+    // clang-format off
+    desc.add_options()
+        ("help,h", "print usage")
+        ("endpoint", po::value(&config.endpoint)->default_value("localhost:8081"),
+         "gRPC endpoint of the service")
+        ("output,o", po::value(&config.output)->default_value("-"),
+         "path of the JSON report, '-' for stdout")
+        ("concurrency,c", po::value(&config.concurrency)->default_value(16),
+         "number of concurrent client threads")
+        ("duration", po::value(&config.duration_s)->default_value(30),
+         "measured duration, seconds")
+        ("warmup", po::value(&config.warmup_s)->default_value(5),
+         "warmup duration excluded from the report, seconds")
+        ("timeout-ms", po::value(&config.timeout_ms)->default_value(1000),
+         "per-call deadline")
+        ("rate", po::value(&config.rate)->default_value(0),
+         "open loop: total requests per second spread over the workers, "
+         "latency counted from the scheduled start; 0 runs closed loop")
+        ("users", po::value(&config.users)->default_value(10000),
+         "number of distinct users")
+        ("zipf-s", po::value(&config.zipf_s)->default_value(0.99),
+         "Zipf exponent of the user popularity skew, 0 is uniform")
+        ("library-median", po::value(&config.library_median)->default_value(20),
+         "median library size")
+        ("library-sigma", po::value(&config.library_sigma)->default_value(1.2),
+         "log-normal sigma of the library size distribution")
+        ("library-max", po::value(&config.library_max)->default_value(5000),
+         "upper bound for a single library size")
+        ("page-size", po::value(&config.page_size)->default_value(50),
+         "GetUserLibrary page size")
+        ("mix", po::value(&mix)->default_value("20:70:10"),
+         "UpdateLibraryEntry:GetUserLibrary:GetLibraryStats weights")
+        ("prefill", po::value(&config.prefill)->default_value(true),
+         "upsert every generated library before measuring")
+        ("seed", po::value(&config.seed)->default_value(42),
+         "random seed");
+    // clang-format on
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    }
+    catch (const std::exception& e)
+    {
+        return usage_error(e.what());
+    }
+
+    if (vm.count("help"))
+    {
+        std::cout << desc << '\n';
+        return 0;
+    }
+
+    auto parsed_mix = load_generator::ParseMix(mix);
+    if (!parsed_mix)
+        return usage_error("invalid --mix '" + mix +
+                           "': expected three non-negative weights "
+                           "separated by ':', not all zero");
+    config.mix = std::move(*parsed_mix);
+
+    if (config.users == 0 || config.concurrency == 0 ||
+        config.page_size <= 0 || !(config.rate >= 0) ||
+        !std::isfinite(config.rate))
+        return usage_error("invalid options");
+
+    return load_generator::Run(config);
+}
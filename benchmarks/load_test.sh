@@ -0,0 +1,34 @@
+#!/bin/bash
+# Reproducible local load test: a fresh Postgres, the service on the
+# testing config, one load generator run, then teardown.
+#
+# Usage: benchmarks/load_test.sh [BUILD_DIR] [OUTPUT] [-- load generator args]
+
+set -euo pipefail
+cd "$(dirname "$0")/.."
+source benchmarks/local_env.sh
+
+BUILD_DIR=${1:-build-release}
+OUTPUT=${2:-${BUILD_DIR}/load_test.json}
+shift $(( $# > 2 ? 2 : $# ))
+[ "${1:-}" = "--" ] && shift
+
+service_pid=
+cleanup() {
+    [ -n "${service_pid}" ] && kill "${service_pid}" 2>/dev/null || true
+    stop_postgres
+}
+trap cleanup EXIT
+
+start_postgres
+
+"${BUILD_DIR}/library-service" \
+    --config configs/static_config.yaml \
+    --config_vars configs/config_vars.testing.yaml &
+service_pid=$!
+wait_for_port "${GRPC_PORT}"
+
+"${BUILD_DIR}/library-service-load-generator" \
+    --endpoint "localhost:${GRPC_PORT}" \
+    --output "${OUTPUT}" \
+    "$@"
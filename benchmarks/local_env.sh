@@ -0,0 +1,63 @@
+# Local environment for load tests, sourced by load_test.sh and scaling.sh
+# (and postgresql/tests/migration_test.sh).
+#
+# Starts a throwaway Postgres in docker that matches
+# configs/config_vars.testing.yaml
+# (postgresql://testsuite@localhost:15433/library_service_db_1) and loads
+# the schema, so every run starts from the same empty database.
+
+PG_CONTAINER=${PG_CONTAINER:-library-service-load-test-pg}
+PG_IMAGE=${PG_IMAGE:-postgres:16}
+PG_PORT=15433
+PG_USER=testsuite
+PG_DB=library_service_db_1
+GRPC_PORT=8081
+
+# start_postgres [SCHEMA_FILE], postgresql/schemas/playhub.sql by default
+start_postgres() {
+    local schema=${1:-postgresql/schemas/playhub.sql}
+
+    docker rm -f "${PG_CONTAINER}" >/dev/null 2>&1 || true
+    docker run -d --name "${PG_CONTAINER}" \
+        -p "${PG_PORT}:5432" \
+        -e POSTGRES_USER="${PG_USER}" \
+        -e POSTGRES_DB="${PG_DB}" \
+        -e POSTGRES_HOST_AUTH_METHOD=trust \
+        "${PG_IMAGE}" >/dev/null
+
+    # Over TCP: the temporary server of the image's init step listens on
+    # the unix socket only, so this waits for the final server.
+    for _ in $(seq 60); do
+        if docker exec "${PG_CONTAINER}" \
+            pg_isready -h 127.0.0.1 -U "${PG_USER}" -d "${PG_DB}" >/dev/null 2>&1; then
+            break
+        fi
+        sleep 1
+    done
+
+    run_psql -d "${PG_DB}" < "${schema}" >/dev/null
+}
+
+# run_psql PSQL_ARGS..., reads SQL from stdin unless -c is given
+run_psql() {
+    docker exec -i "${PG_CONTAINER}" \
+        psql -q -v ON_ERROR_STOP=1 -U "${PG_USER}" "$@"
+}
+
+stop_postgres() {
+    docker rm -f "${PG_CONTAINER}" >/dev/null 2>&1 || true
+}
+
+# wait_for_port PORT [TIMEOUT_S]
+wait_for_port() {
+    local port=$1 timeout=${2:-60}
+    for _ in $(seq "${timeout}"); do
+        if (exec 3<>"/dev/tcp/127.0.0.1/${port}") 2>/dev/null; then
+            return 0
+        fi
+        sleep 1
+    done
+
+    echo "nothing listens on port ${port} after ${timeout}s" >&2
+    return 1
+}
@@ -0,0 +1,84 @@
+#!/bin/bash
+# Measures how throughput scales with the number of cores given to the
+# service. For every core count the service is pinned to cores
+# [0, N) and the load generator to the remaining ones, so run it on a host
+# with at least twice the largest core count.
+#
+# Usage: benchmarks/scaling.sh [BUILD_DIR] [OUTPUT_DIR] [-- load generator args]
+
+set -euo pipefail
+cd "$(dirname "$0")/.."
+source benchmarks/local_env.sh
+
+BUILD_DIR=${1:-build-release}
+OUTPUT_DIR=${2:-${BUILD_DIR}/scaling}
+shift $(( $# > 2 ? 2 : $# ))
+[ "${1:-}" = "--" ] && shift
+
+CORE_COUNTS=${CORE_COUNTS:-"1 2 4 8 16 32 64"}
+TOTAL_CORES=$(nproc)
+SERVICE="${BUILD_DIR}/library-service"
+LOAD_GENERATOR="${BUILD_DIR}/library-service-load-generator"
+
+mkdir -p "${OUTPUT_DIR}"
+
+service_pid=
+cleanup() {
+    [ -n "${service_pid}" ] && kill "${service_pid}" 2>/dev/null || true
+    stop_postgres
+}
+trap cleanup EXIT
+
+start_postgres
+
+# Data only has to be loaded once, later runs reuse it
+prefill=true
+
+for cores in ${CORE_COUNTS}; do
+    if (( cores >= TOTAL_CORES )); then
+        echo "skipping ${cores} cores: host has ${TOTAL_CORES}" >&2
+        continue
+    fi
+
+    # Unset so the service derives its topology from the pinned core count
+    env -u LIBRARY_GRPC_COMPLETION_QUEUES \
+        -u LIBRARY_GRPC_WORKER_THREADS \
+        -u LIBRARY_MAIN_WORKER_THREADS \
+        taskset -c "0-$((cores - 1))" "${SERVICE}" \
+            --config configs/static_config.yaml \
+            --config_vars configs/config_vars.testing.yaml &
+    service_pid=$!
+    wait_for_port "${GRPC_PORT}"
+
+    taskset -c "${cores}-$((TOTAL_CORES - 1))" "${LOAD_GENERATOR}" \
+        --output "${OUTPUT_DIR}/cores-${cores}.json" \
+        --prefill "${prefill}" \
+        "$@"
+    prefill=false
+
+    kill "${service_pid}"
+    wait "${service_pid}" || true
+    service_pid=
+done
+
+# The summary records what the numbers were measured on; commit it to
+# benchmarks/results/ together with a change of the topology defaults.
+{
+    echo "commit: $(git rev-parse --short HEAD 2>/dev/null || echo unknown)"
+    echo "cpu: $(lscpu 2>/dev/null | sed -n 's/^Model name: *//p')"
+    echo "host cores: ${TOTAL_CORES}"
+    echo "load generator args: $*"
+    echo
+    printf "%6s %12s %10s %10s\n" cores rps p99_us p999_us
+    for report in "${OUTPUT_DIR}"/cores-*.json; do
+        python3 - "${report}" <<'PY'
+import json, re, sys
+report = json.load(open(sys.argv[1]))
+cores = re.search(r"cores-(\d+)", sys.argv[1]).group(1)
+total = report["total"]
+print("%6s %12.0f %10d %10d" % (cores, total["throughput_rps"],
+                                total["latency_us"]["p99"],
+                                total["latency_us"]["p999"]))
+PY
+    done | sort -n
+} | tee "${OUTPUT_DIR}/summary.txt"
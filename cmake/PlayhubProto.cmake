@@ -0,0 +1,129 @@
+include_guard(GLOBAL)
+
+# playhub-proto revision the service is built against. The default branch
+# until library-service-v2 is tagged upstream; switch the default to that
+# tag then.
+set(PLAYHUB_PROTO_GIT_TAG "HEAD" CACHE STRING
+    "playhub-proto tag to build against")
+
+# RPCs of library.LibraryService every build implements.
+set(LIBRARY_SERVICE_REQUIRED_RPCS
+    UpdateLibraryEntry
+    GetUserLibrary
+    GetLibraryStats
+)
+
+# RPCs of the library-service-v2 proto release. They are compiled in, with
+# LIBRARY_SERVICE_PROTO_V2 defined, only if library.proto has all of them.
+set(LIBRARY_SERVICE_V2_RPCS
+    GetLibraryEntry
+    WatchLibraryChanges
+    GetLibraryAnalytics
+    RemoveLibraryEntry
+    PurgeUserLibrary
+)
+
+# Sets PLAYHUB_PROTO_DIR to a playhub-proto checkout: TRY_DIR when it
+# exists (local development), the pinned tag fetched with CPM otherwise.
+function(download_playhub_proto)
+    set(OPTIONS)
+    set(ONE_VALUE_ARGS TRY_DIR GIT_TAG)
+    set(MULTI_VALUE_ARGS)
+    cmake_parse_arguments(ARG "${OPTIONS}" "${ONE_VALUE_ARGS}" "${MULTI_VALUE_ARGS}" ${ARGN})
+
+    if(NOT DEFINED ARG_GIT_TAG)
+        set(ARG_GIT_TAG ${PLAYHUB_PROTO_GIT_TAG})
+    endif()
+
+    if(ARG_TRY_DIR)
+        get_filename_component(ARG_TRY_DIR "${ARG_TRY_DIR}" REALPATH)
+        if(EXISTS "${ARG_TRY_DIR}")
+            message(STATUS "Using playhub-proto from ${ARG_TRY_DIR}")
+            _playhub_proto_check_tag("${ARG_TRY_DIR}" "${ARG_GIT_TAG}")
+            set(PLAYHUB_PROTO_DIR "${ARG_TRY_DIR}" PARENT_SCOPE)
+            return()
+        endif()
+    endif()
+
+    include(get_cpm)
+
+    cpmaddpackage(
+        NAME
+        playhub-proto
+        GIT_REPOSITORY
+        https://github.com/viktoralyoshin/playhub-proto.git
+        GIT_TAG
+        ${ARG_GIT_TAG}
+        DOWNLOAD_ONLY
+        YES
+    )
+
+    set(PLAYHUB_PROTO_DIR "${playhub-proto_SOURCE_DIR}" PARENT_SCOPE)
+endfunction()
+
+# Fails the configuration if library.proto lacks a required RPC or has only
+# some of LIBRARY_SERVICE_V2_RPCS; sets LIBRARY_SERVICE_PROTO_V2 in the
+# caller's scope.
+function(check_playhub_proto_rpcs PROTO_FILE)
+    file(READ "${PROTO_FILE}" PROTO_CONTENT)
+
+    _playhub_proto_missing_rpcs(MISSING_RPCS "${PROTO_CONTENT}" ${LIBRARY_SERVICE_REQUIRED_RPCS})
+    if(MISSING_RPCS)
+        string(REPLACE ";" ", " MISSING_RPCS "${MISSING_RPCS}")
+        message(FATAL_ERROR "${PROTO_FILE} lacks rpc ${MISSING_RPCS}")
+    endif()
+
+    _playhub_proto_missing_rpcs(MISSING_RPCS "${PROTO_CONTENT}" ${LIBRARY_SERVICE_V2_RPCS})
+    if(NOT MISSING_RPCS)
+        message(STATUS "playhub-proto has the library-service-v2 RPCs")
+        set(LIBRARY_SERVICE_PROTO_V2 ON PARENT_SCOPE)
+        return()
+    endif()
+
+    list(LENGTH LIBRARY_SERVICE_V2_RPCS V2_RPC_COUNT)
+    list(LENGTH MISSING_RPCS MISSING_RPC_COUNT)
+    string(REPLACE ";" ", " MISSING_RPCS "${MISSING_RPCS}")
+    if(NOT MISSING_RPC_COUNT EQUAL V2_RPC_COUNT)
+        message(FATAL_ERROR
+            "${PROTO_FILE} lacks rpc ${MISSING_RPCS} of library-service-v2; "
+            "check out a playhub-proto revision with all of them or none")
+    endif()
+
+    message(WARNING
+        "playhub-proto at ${PLAYHUB_PROTO_GIT_TAG} predates library-service-v2, "
+        "building without rpc ${MISSING_RPCS}")
+    set(LIBRARY_SERVICE_PROTO_V2 OFF PARENT_SCOPE)
+endfunction()
+
+# Sets OUT to the list of RPCs missing from CONTENT.
+function(_playhub_proto_missing_rpcs OUT CONTENT)
+    set(MISSING)
+    foreach(RPC ${ARGN})
+        if(NOT CONTENT MATCHES "rpc[ \t\r\n]+${RPC}[ \t\r\n]*\\(")
+            list(APPEND MISSING ${RPC})
+        endif()
+    endforeach()
+
+    set(${OUT} "${MISSING}" PARENT_SCOPE)
+endfunction()
+
+# A local checkout may sit on any revision; only warn, the RPC check above
+# is what actually guards the build.
+function(_playhub_proto_check_tag DIR TAG)
+    find_package(Git QUIET)
+    if(TAG STREQUAL "HEAD" OR NOT GIT_FOUND OR NOT EXISTS "${DIR}/.git")
+        return()
+    endif()
+
+    execute_process(
+        COMMAND ${GIT_EXECUTABLE} describe --tags --exact-match
+        WORKING_DIRECTORY "${DIR}"
+        OUTPUT_VARIABLE CHECKED_OUT_TAG
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+        ERROR_QUIET
+    )
+
+    if(NOT CHECKED_OUT_TAG STREQUAL TAG)
+        message(WARNING "playhub-proto in ${DIR} is not at the pinned tag ${TAG}")
+    endif()
+endfunction()
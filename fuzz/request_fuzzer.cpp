@@ -0,0 +1,107 @@
+// libFuzzer entry point over request decoding and validation.
+//
+// The first input byte selects the message, the rest is parsed as its wire
+// form. Anything Validate() accepts must be safe to hand to the repository:
+// the ids parse as uuids and the status maps to a playhub.game_status.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+#include <boost/uuid/uuid_io.hpp>
+
+#include <handlers/request_validation.hpp>
+#include <structs/game_status.hpp>
+#include <tools/uuid.hpp>
+
+namespace {
+
+void Check(bool condition)
+{
+    if (!condition)
+        std::abort();
+}
+
+void CheckAcceptedUuid(std::string_view value)
+{
+    const auto uuid = utils::ParseUuid(value);
+    Check(uuid.has_value());
+
+    // The parsed id is the same value Postgres would read from the text.
+    const auto canonical = boost::uuids::to_string(*uuid);
+    Check(canonical.size() == value.size());
+    for (std::size_t i = 0; i < value.size(); ++i)
+    {
+        const auto c = value[i] >= 'A' && value[i] <= 'F'
+                           ? static_cast<char>(value[i] - 'A' + 'a')
+                           : value[i];
+        Check(canonical[i] == c);
+    }
+}
+
+void FuzzUpdateLibraryEntry(const std::uint8_t* data, std::size_t size)
+{
+    ::library::UpdateLibraryEntryRequest request;
+    if (!request.ParseFromArray(data, static_cast<int>(size)))
+        return;
+
+    if (!library_service::Validate(request).ok())
+        return;
+
+    CheckAcceptedUuid(request.user_id());
+    CheckAcceptedUuid(request.game_id());
+    Check(entities::ToProto(entities::FromProto(request.status())) ==
+          request.status());
+}
+
+void FuzzGetUserLibrary(const std::uint8_t* data, std::size_t size)
+{
+    ::library::GetUserLibraryRequest request;
+    if (!request.ParseFromArray(data, static_cast<int>(size)))
+        return;
+
+    if (!library_service::Validate(request).ok())
+        return;
+
+    CheckAcceptedUuid(request.user_id());
+    Check(request.limit() >= 0 && request.offset() >= 0);
+}
+
+void FuzzUuid(const std::uint8_t* data, std::size_t size)
+{
+    const std::string_view value(reinterpret_cast<const char*>(data), size);
+
+    const auto valid = utils::IsValidUuid(value);
+    Check(valid == utils::ParseUuid(value).has_value());
+    if (valid)
+        CheckAcceptedUuid(value);
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data,
+                                      std::size_t size)
+{
+    if (size == 0)
+        return 0;
+
+    const auto selector = data[0];
+    ++data;
+    --size;
+
+    switch (selector % 3)
+    {
+    case 0:
+        FuzzUpdateLibraryEntry(data, size);
+        break;
+    case 1:
+        FuzzGetUserLibrary(data, size);
+        break;
+    default:
+        FuzzUuid(data, size);
+        break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <userver/yaml_config/yaml_config.hpp>
+
+#include <repository/repository.hpp>
+
+namespace library_service {
+
+struct ChangeStreamConfig
+{
+    // Number of outbox shards; a user always lands in the same one.
+    std::int32_t shards = pg::kDefaultOutboxShards;
+    // Transactions read from the outbox at once.
+    std::int32_t batch_size = 500;
+    std::chrono::milliseconds poll_interval{ 200 };
+};
+
+ChangeStreamConfig Parse(const userver::yaml_config::YamlConfig& value,
+                         userver::formats::parse::To<ChangeStreamConfig>);
+
+} // namespace library_service
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+
+#include <google/protobuf/message.h>
+#include <grpcpp/server_context.h>
+
+#include <userver/utils/statistics/metric_tag.hpp>
+#include <userver/utils/statistics/rate_counter.hpp>
+#include <userver/yaml_config/yaml_config.hpp>
+
+namespace library_service {
+
+struct CompressionConfig
+{
+    bool enabled = false;
+    grpc_compression_algorithm algorithm = GRPC_COMPRESS_GZIP;
+    // Responses smaller than this are sent as is: the gzip header and CPU
+    // cost outweigh the savings on small messages.
+    std::size_t min_size_bytes = 4096;
+};
+
+CompressionConfig Parse(const userver::yaml_config::YamlConfig& value,
+                        userver::formats::parse::To<CompressionConfig>);
+
+// Output size and CPU time of the compression are not available: grpc
+// compresses in core, below interceptors and middlewares, and does not
+// report either through its C++ API. See README, "Response compression".
+struct CompressionMetrics
+{
+    userver::utils::statistics::RateCounter compressed;
+    userver::utils::statistics::RateCounter skipped_small;
+    userver::utils::statistics::RateCounter compressed_input_bytes;
+};
+
+void DumpMetric(userver::utils::statistics::Writer& writer,
+                const CompressionMetrics& metrics);
+
+extern const userver::utils::statistics::MetricTag<CompressionMetrics>
+    kCompressionMetricsTag;
+
+enum class CompressionDecision
+{
+    kCompress,
+    kDisabled,
+    kSkipSmall,
+};
+
+// Chooses per-call gRPC message compression for responses. Whether the
+// client accepts the algorithm is left to grpc core: it parses
+// grpc-accept-encoding itself (the header never reaches client_metadata())
+// and sends the message uncompressed to peers that do not accept it.
+class CompressionPolicy
+{
+public:
+    // Disabled policy, never compresses.
+    CompressionPolicy() = default;
+    CompressionPolicy(CompressionConfig config, CompressionMetrics& metrics);
+
+    CompressionDecision Decide(std::size_t message_size) const;
+
+    // Must be called before the response is returned from the handler.
+    void Apply(grpc::ServerContext& context,
+               const google::protobuf::Message& response) const;
+
+private:
+    CompressionConfig config_;
+    CompressionMetrics* metrics_ = nullptr;
+};
+
+} // namespace library_service
@@ -1,15 +1,33 @@
 #pragma once
 
+#include <handlers/change_stream.hpp>
+#include <handlers/compression_policy.hpp>
+#include <handlers/membership_cache.hpp>
+#include <handlers/tombstone_compaction.hpp>
 #include <library/library_service.usrv.pb.hpp>
 #include <repository/postgres_manager.hpp>
+#include <tools/slow_request_log.hpp>
+
+#include <userver/utils/periodic_task.hpp>
 
 namespace library_service {
 
+struct LibraryServiceOptions
+{
+    CompressionPolicy compression;
+    utils::SlowRequestConfig slow_request;
+    MembershipCacheConfig membership_cache;
+    ChangeStreamConfig change_stream;
+    // Entries removed per statement by PurgeUserLibrary.
+    std::int32_t purge_batch_size = 1000;
+};
+
 class LibraryService final : public ::library::LibraryServiceBase
 {
 public:
     explicit LibraryService(std::string prefix,
-                            const pg::ILibraryRepository& manager);
+                            const pg::ILibraryRepository& manager,
+                            LibraryServiceOptions options = {});
 
     UpdateLibraryEntryResult
     UpdateLibraryEntry(CallContext& context,
@@ -22,12 +40,43 @@ public:
     GetLibraryStats(CallContext& context,
                     ::library::GetLibraryStatsRequest&& request) override;
 
+#ifdef LIBRARY_SERVICE_PROTO_V2
+    GetLibraryEntryResult
+    GetLibraryEntry(CallContext& context,
+                    ::library::GetLibraryEntryRequest&& request) override;
+
+    RemoveLibraryEntryResult
+    RemoveLibraryEntry(CallContext& context,
+                       ::library::RemoveLibraryEntryRequest&& request) override;
+
+    PurgeUserLibraryResult
+    PurgeUserLibrary(CallContext& context,
+                     ::library::PurgeUserLibraryRequest&& request) override;
+
+    WatchLibraryChangesResult
+    WatchLibraryChanges(CallContext& context,
+                        ::library::WatchLibraryChangesRequest&& request,
+                        WatchLibraryChangesWriter& writer) override;
+
+    GetLibraryAnalyticsResult
+    GetLibraryAnalytics(CallContext& context,
+                        ::library::GetLibraryAnalyticsRequest&& request) override;
+#endif
+
+    // See LibraryMembershipCache::Refresh().
+    void RefreshMembershipCache();
+
 private:
     void FillLibraryEntry(const entities::LibraryPostgres& db_entry,
                           ::library::LibraryEntry& proto);
 
     std::string prefix_;
     const pg::ILibraryRepository& pg_manager_;
+    CompressionPolicy compression_;
+    utils::SlowRequestConfig slow_request_;
+    LibraryMembershipCache membership_cache_;
+    ChangeStreamConfig change_stream_;
+    std::int32_t purge_batch_size_;
 };
 
 class LibraryServiceComponent final
@@ -45,6 +94,10 @@ public:
 private:
     pg::PostgresManager pg_manager_;
     LibraryService service_;
+    // Declared last so that they stop before service_ and pg_manager_ are
+    // destroyed.
+    userver::utils::PeriodicTask membership_task_;
+    userver::utils::PeriodicTask compaction_task_;
 };
 
 } // namespace library_service
\ No newline at end of file
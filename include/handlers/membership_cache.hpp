@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/uuid/uuid.hpp>
+
+#include <userver/cache/lru_map.hpp>
+#include <userver/engine/mutex.hpp>
+#include <userver/yaml_config/yaml_config.hpp>
+
+#include <repository/repository.hpp>
+#include <tools/bloom_filter.hpp>
+
+namespace library_service {
+
+struct MembershipCacheConfig
+{
+    bool enabled = true;
+    std::size_t max_users = 100000;
+    double false_positive_rate = 0.01;
+    // Period of LibraryMembershipCache::Refresh().
+    std::chrono::milliseconds refresh_period{ 100 };
+    // "Not in library" is only answered from a filter while the last
+    // completed outbox pass started less than this long ago; otherwise
+    // lookups go to the database.
+    std::chrono::milliseconds max_staleness{ 1000 };
+    // Outbox events read per query.
+    std::int32_t batch_size = 1000;
+    // Filters built per refresh, the remaining users wait for the next one.
+    std::int32_t max_builds = 100;
+};
+
+MembershipCacheConfig Parse(const userver::yaml_config::YamlConfig& value,
+                            userver::formats::parse::To<MembershipCacheConfig>);
+
+// Per-user Bloom filters over the game ids of each library, used to answer
+// "not in library" without a database round trip. Filters are built in the
+// background for users that were looked up, and kept current by following
+// the playhub.library_changes outbox, so writes made through any instance
+// reach them within max_staleness.
+class LibraryMembershipCache
+{
+public:
+    LibraryMembershipCache(MembershipCacheConfig config,
+                           const pg::ILibraryRepository& repository);
+
+    // Returns false only if the game is definitely not in the library. Never
+    // queries the database: users without a filter are queued for a build
+    // and answered with true.
+    bool MayContain(const boost::uuids::uuid& user_id,
+                    const boost::uuids::uuid& game_id);
+
+    // Must be called after every successful upsert made by this instance,
+    // makes it visible before the outbox pass picks it up.
+    void Add(const boost::uuids::uuid& user_id,
+             const boost::uuids::uuid& game_id);
+
+    // Applies outbox events written since the previous call to the filters,
+    // then builds filters for queued users. Run periodically by the
+    // component; database errors are logged and leave the filters stale,
+    // which turns negative answers off once max_staleness passes.
+    void Refresh();
+
+private:
+    struct Entry
+    {
+        std::optional<utils::BloomFilter> filter;
+        // Waits in pending_builds_.
+        bool queued = false;
+        // An upsert raced with the build, the filter may miss its game.
+        bool dirty = false;
+    };
+
+    void FollowChanges();
+    void BuildQueued();
+    void Build(const boost::uuids::uuid& user_id);
+    // Adds the game to a built filter, or drops a filter that is full.
+    void AddLocked(Entry& entry, const boost::uuids::uuid& user_id,
+                   const boost::uuids::uuid& game_id);
+
+    MembershipCacheConfig config_;
+    const pg::ILibraryRepository& repository_;
+
+    userver::engine::Mutex mutex_;
+    userver::cache::LruMap<boost::uuids::uuid, Entry,
+                           boost::hash<boost::uuids::uuid>>
+        filters_;
+    std::vector<boost::uuids::uuid> pending_builds_;
+    // Start of the last outbox pass that caught up, all transactions that
+    // committed before it are applied to the filters.
+    std::optional<std::chrono::steady_clock::time_point> synced_at_;
+
+    // Owned by Refresh(): events of transactions below it are applied.
+    std::optional<std::int64_t> applied_xmin_;
+};
+
+} // namespace library_service
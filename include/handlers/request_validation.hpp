@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+#include <grpcpp/support/status.h>
+
+#include <library/library.pb.h>
+
+namespace library_service {
+
+inline constexpr std::int32_t kDefaultAnalyticsDays = 30;
+inline constexpr std::int32_t kMaxAnalyticsDays = 365;
+
+// Checks run by the handlers before any repository call. Each returns OK
+// for a valid request and INVALID_ARGUMENT otherwise; a valid request is
+// checked without allocating.
+grpc::Status Validate(const ::library::UpdateLibraryEntryRequest& request);
+grpc::Status Validate(const ::library::GetUserLibraryRequest& request);
+grpc::Status Validate(const ::library::GetLibraryStatsRequest& request);
+#ifdef LIBRARY_SERVICE_PROTO_V2
+grpc::Status Validate(const ::library::GetLibraryEntryRequest& request);
+grpc::Status Validate(const ::library::RemoveLibraryEntryRequest& request);
+grpc::Status Validate(const ::library::PurgeUserLibraryRequest& request);
+grpc::Status Validate(const ::library::GetLibraryAnalyticsRequest& request);
+// The upper shard bound depends on the change-stream config and is checked
+// by the handler.
+grpc::Status Validate(const ::library::WatchLibraryChangesRequest& request);
+#endif
+
+} // namespace library_service
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+#include <userver/yaml_config/yaml_config.hpp>
+
+#include <repository/repository.hpp>
+
+namespace library_service {
+
+struct TombstoneCompactionConfig
+{
+    bool enabled = true;
+    // Removed entries older than this are deleted for good.
+    std::chrono::hours retention{ 24 * 7 };
+    std::chrono::milliseconds period{ 60000 };
+    std::int32_t batch_size = 1000;
+    // Caps the rows deleted per run at batch_size * max_batches; the rest
+    // waits for the next period.
+    std::int32_t max_batches = 100;
+    // Pause between batches, lets autovacuum and replicas keep up.
+    std::chrono::milliseconds batch_pause{ 100 };
+    // WatchLibraryChanges events older than this are deleted; a subscriber
+    // that falls further behind misses them.
+    std::chrono::hours outbox_retention{ 24 * 7 };
+};
+
+TombstoneCompactionConfig
+Parse(const userver::yaml_config::YamlConfig& value,
+      userver::formats::parse::To<TombstoneCompactionConfig>);
+
+// Physically deletes tombstones left by RemoveLibraryEntry and
+// PurgeUserLibrary, then expired outbox events, in small batches, so that
+// each DELETE holds its row locks briefly and produces a bounded amount of
+// dead tuples.
+class TombstoneCompactor
+{
+public:
+    TombstoneCompactor(TombstoneCompactionConfig config,
+                       const pg::ILibraryRepository& repository);
+
+    // One compaction pass, returns the number of deleted rows. Each table
+    // gets up to max_batches statements and stops early on a partial batch
+    // or task cancellation.
+    std::int64_t Run() const;
+
+private:
+    // Calls delete_batch(batch_size) until a batch comes back partial,
+    // returns the total of its results.
+    template <typename DeleteBatch>
+    std::int64_t DeleteInBatches(std::string_view what,
+                                 DeleteBatch delete_batch) const;
+
+    TombstoneCompactionConfig config_;
+    const pg::ILibraryRepository& repository_;
+};
+
+} // namespace library_service
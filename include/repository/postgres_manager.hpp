@@ -1,6 +1,7 @@
 #pragma once
 
 #include <repository/repository.hpp>
+#include <userver/engine/task/task_processor_fwd.hpp>
 #include <userver/storages/postgres/cluster.hpp>
 
 namespace pg {
@@ -8,20 +9,64 @@ namespace pg {
 class PostgresManager final : public pg::ILibraryRepository
 {
 public:
+    // When db_task_processor is set, queries and row parsing run there
+    // instead of on the caller's task processor.
     explicit PostgresManager(
-        userver::storages::postgres::ClusterPtr pg_cluster);
+        userver::storages::postgres::ClusterPtr pg_cluster,
+        userver::engine::TaskProcessor* db_task_processor = nullptr,
+        std::int32_t outbox_shards = kDefaultOutboxShards);
 
     LibraryPostgres CreateLibraryEntry(std::string_view user_id,
                                        std::string_view game_id,
-                                       std::string_view) const override;
+                                       entities::GameStatus) const override;
     LibrariesPostgres GetLibraryEntries(std::string_view user_id,
                                         std::int32_t limit,
                                         std::int32_t offset) const override;
 
     std::int32_t GetLibraryStats(std::string_view user_id) const override;
 
+    std::optional<LibraryPostgres>
+    GetLibraryEntry(std::string_view user_id,
+                    std::string_view game_id) const override;
+    std::vector<boost::uuids::uuid>
+    GetLibraryGameIds(std::string_view user_id) const override;
+
+    bool RemoveLibraryEntry(std::string_view user_id,
+                            std::string_view game_id) const override;
+    std::int32_t PurgeUserLibrary(std::string_view user_id,
+                                  std::int32_t limit) const override;
+    std::int32_t DeleteTombstones(std::chrono::milliseconds retention,
+                                  std::int32_t limit) const override;
+
+    LibraryChangesPostgres
+    GetLibraryChanges(std::int32_t shard, std::int64_t after,
+                      std::int32_t limit) const override;
+    LibraryChangesPostgres
+    GetLibraryChangesSince(std::int64_t min_txid, std::int64_t after,
+                           std::int32_t limit) const override;
+    std::int64_t GetOutboxXmin() const override;
+    std::int32_t DeleteLibraryChanges(std::chrono::milliseconds retention,
+                                      std::int32_t limit) const override;
+
+    StatusCountsPostgres
+    GetStatusCounts(std::string_view user_id) const override;
+    DailyActivitiesPostgres GetDailyActivity(std::string_view user_id,
+                                             std::int32_t days) const override;
+
 private:
+    template <typename Func>
+    auto RunOnDbTaskProcessor(Func&& func) const;
+
+    // Executes the query inside its own span and reports it to the slow
+    // request log; parse converts the result set on the DB task processor.
+    template <typename Parse, typename... Args>
+    auto RunQuery(std::string_view span_name,
+                  const userver::storages::postgres::Query& query,
+                  Parse&& parse, const Args&... args) const;
+
     userver::storages::postgres::ClusterPtr pg_cluster_;
+    userver::engine::TaskProcessor* db_task_processor_;
+    std::int32_t outbox_shards_;
 };
 
 } // namespace pg
@@ -1,27 +1,92 @@
 #pragma once
 
+#include <chrono>
+#include <optional>
 #include <string_view>
 #include <vector>
 
+#include <boost/uuid/uuid.hpp>
+
 #include <structs/library_postgres.hpp>
 
 namespace pg {
 
+inline constexpr std::int32_t kDefaultOutboxShards = 16;
+
 class ILibraryRepository
 {
 public:
     using LibraryPostgres = entities::LibraryPostgres;
     using LibrariesPostgres = std::vector<entities::LibraryPostgres>;
+    using LibraryChangesPostgres =
+        std::vector<entities::LibraryChangePostgres>;
+    using StatusCountsPostgres = std::vector<entities::StatusCountPostgres>;
+    using DailyActivitiesPostgres =
+        std::vector<entities::DailyActivityPostgres>;
 
     virtual ~ILibraryRepository() = default;
 
+    // Also records the change in the playhub.library_changes outbox and
+    // updates the analytics rollups.
     virtual LibraryPostgres
     CreateLibraryEntry(std::string_view user_id, std::string_view game_id,
-                       std::string_view game_status) const = 0;
+                       entities::GameStatus game_status) const = 0;
+    // Reads below skip removed entries.
     virtual LibrariesPostgres GetLibraryEntries(std::string_view user_id,
                                                 std::int32_t limit,
                                                 std::int32_t offset) const = 0;
     virtual std::int32_t GetLibraryStats(std::string_view user_id) const = 0;
+
+    // Unlike the methods above, the ones below let database errors
+    // propagate: an empty answer would be cached as "not in library" or
+    // read as "no new changes".
+    virtual std::optional<LibraryPostgres>
+    GetLibraryEntry(std::string_view user_id,
+                    std::string_view game_id) const = 0;
+    virtual std::vector<boost::uuids::uuid>
+    GetLibraryGameIds(std::string_view user_id) const = 0;
+
+    // Soft removal: rows are tombstoned, recorded in the outbox as removed
+    // and subtracted from the rollups. Removing an absent or already removed
+    // entry is a no-op. Return whether / how many entries were removed.
+    virtual bool RemoveLibraryEntry(std::string_view user_id,
+                                    std::string_view game_id) const = 0;
+    // Removes up to limit entries of the user, in its own transaction; the
+    // library is empty once a call returns less than limit.
+    virtual std::int32_t PurgeUserLibrary(std::string_view user_id,
+                                          std::int32_t limit) const = 0;
+    // Physically deletes up to limit tombstones older than retention and
+    // returns the number of deleted rows.
+    virtual std::int32_t DeleteTombstones(std::chrono::milliseconds retention,
+                                          std::int32_t limit) const = 0;
+
+    // Outbox events of up to limit finished transactions of one shard with
+    // txid > after, oldest first. Events of one transaction are adjacent.
+    virtual LibraryChangesPostgres
+    GetLibraryChanges(std::int32_t shard, std::int64_t after,
+                      std::int32_t limit) const = 0;
+    // Outbox events of every shard with txid >= min_txid and
+    // change_id > after, by change_id, including those of transactions that
+    // are not below the snapshot xmin yet.
+    virtual LibraryChangesPostgres
+    GetLibraryChangesSince(std::int64_t min_txid, std::int64_t after,
+                           std::int32_t limit) const = 0;
+    // xmin of the current snapshot: every transaction with a smaller id has
+    // finished, every later event gets a txid at or above it.
+    virtual std::int64_t GetOutboxXmin() const = 0;
+    // Deletes up to limit outbox events older than retention and returns the
+    // number of deleted rows.
+    virtual std::int32_t
+    DeleteLibraryChanges(std::chrono::milliseconds retention,
+                         std::int32_t limit) const = 0;
+
+    // Analytics rollups maintained by CreateLibraryEntry.
+    virtual StatusCountsPostgres
+    GetStatusCounts(std::string_view user_id) const = 0;
+    // Per-day, per-status transition counts of the last `days` days, newest
+    // first.
+    virtual DailyActivitiesPostgres
+    GetDailyActivity(std::string_view user_id, std::int32_t days) const = 0;
 };
 
 } // namespace pg
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+#include <library/library.pb.h>
+#include <userver/storages/postgres/io/enum_types.hpp>
+#include <userver/utils/trivial_map.hpp>
+
+namespace entities {
+
+// Values follow the order of playhub.game_status in
+// postgresql/schemas/playhub.sql.
+enum class GameStatus : int
+{
+    kUnspecified = 0,
+    kPlan = 1,
+    kPlaying = 2,
+    kCompleted = 3,
+    kDropped = 4,
+    kWaiting = 5
+};
+
+struct GameStatusMapping
+{
+    GameStatus entity;
+    ::library::GameStatus proto;
+    std::string_view db_name;
+};
+
+// Single source of truth for every game status conversion. Rows are in
+// playhub.game_status order; the static_asserts below keep the proto enum
+// in sync with it and kGameStatusDbNames is generated from it.
+inline constexpr GameStatusMapping kGameStatusMappings[] = {
+    { GameStatus::kUnspecified, ::library::GameStatus::GAME_STATUS_UNSPECIFIED,
+      "unspecified" },
+    { GameStatus::kPlan, ::library::GameStatus::GAME_STATUS_PLAN, "plan" },
+    { GameStatus::kPlaying, ::library::GameStatus::GAME_STATUS_PLAYING,
+      "playing" },
+    { GameStatus::kCompleted, ::library::GameStatus::GAME_STATUS_COMPLETED,
+      "completed" },
+    { GameStatus::kDropped, ::library::GameStatus::GAME_STATUS_DROPPED,
+      "dropped" },
+    { GameStatus::kWaiting, ::library::GameStatus::GAME_STATUS_WAITING,
+      "waiting" },
+};
+
+inline constexpr std::size_t kGameStatusCount =
+    sizeof(kGameStatusMappings) / sizeof(kGameStatusMappings[0]);
+
+// Unknown proto values map to kUnspecified, as proto3 allows them on the
+// wire.
+constexpr GameStatus FromProto(::library::GameStatus status)
+{
+    for (const auto& mapping : kGameStatusMappings)
+    {
+        if (mapping.proto == status)
+            return mapping.entity;
+    }
+
+    return GameStatus::kUnspecified;
+}
+
+constexpr ::library::GameStatus ToProto(GameStatus status)
+{
+    for (const auto& mapping : kGameStatusMappings)
+    {
+        if (mapping.entity == status)
+            return mapping.proto;
+    }
+
+    return ::library::GameStatus::GAME_STATUS_UNSPECIFIED;
+}
+
+constexpr std::string_view ToDbName(GameStatus status)
+{
+    for (const auto& mapping : kGameStatusMappings)
+    {
+        if (mapping.entity == status)
+            return mapping.db_name;
+    }
+
+    return kGameStatusMappings[0].db_name;
+}
+
+namespace impl {
+
+// Feeds every row of kGameStatusMappings to a TrivialBiMap selector, one
+// Case() per row.
+template <typename Selector, std::size_t... Indices>
+constexpr auto GameStatusCases(Selector selector,
+                               std::index_sequence<Indices...>)
+{
+    auto cases = selector.Case(kGameStatusMappings[0].db_name,
+                               kGameStatusMappings[0].entity);
+    (cases.Case(kGameStatusMappings[Indices + 1].db_name,
+                kGameStatusMappings[Indices + 1].entity),
+     ...);
+
+    return cases;
+}
+
+} // namespace impl
+
+// The Postgres mapping userver needs, generated from kGameStatusMappings.
+inline constexpr userver::utils::TrivialBiMap kGameStatusDbNames =
+    [](auto selector) {
+        return impl::GameStatusCases(
+            selector(), std::make_index_sequence<kGameStatusCount - 1>{});
+    };
+
+namespace impl {
+
+constexpr bool IsGameStatusRegistryConsistent()
+{
+    for (std::size_t i = 0; i < kGameStatusCount; ++i)
+    {
+        const auto& mapping = kGameStatusMappings[i];
+
+        if (static_cast<std::size_t>(mapping.entity) != i)
+            return false;
+        if (FromProto(mapping.proto) != mapping.entity)
+            return false;
+
+        for (std::size_t j = 0; j < i; ++j)
+        {
+            if (kGameStatusMappings[j].proto == mapping.proto ||
+                kGameStatusMappings[j].db_name == mapping.db_name)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace impl
+
+static_assert(kGameStatusCount ==
+                  static_cast<std::size_t>(::library::GameStatus_ARRAYSIZE),
+              "every proto GameStatus needs a row in kGameStatusMappings");
+static_assert(impl::IsGameStatusRegistryConsistent(),
+              "kGameStatusMappings must follow playhub.game_status order "
+              "and map every status one to one");
+
+} // namespace entities
+
+template <>
+struct userver::storages::postgres::io::CppToUserPg<entities::GameStatus>
+{
+    static constexpr DBTypeName postgres_name = "playhub.game_status";
+    static constexpr auto enumerators = entities::kGameStatusDbNames;
+};
@@ -1,19 +1,13 @@
 #pragma once
 
+#include <cstdint>
+
 #include <boost/uuid/uuid.hpp>
 #include <userver/storages/postgres/io/chrono.hpp>
 
-namespace entities {
+#include <structs/game_status.hpp>
 
-enum class GameStatus : int
-{
-    kUnspecified = 0,
-    kPlan = 1,
-    kPlaying = 2,
-    kCompleted = 3,
-    kDropped = 4,
-    kWaiting = 5
-};
+namespace entities {
 
 struct LibraryPostgres
 {
@@ -25,4 +19,31 @@ struct LibraryPostgres
     userver::storages::postgres::TimePointWithoutTz updated_at;
 };
 
-} // namespace entities
\ No newline at end of file
+struct LibraryChangePostgres
+{
+    // Id of the writing transaction, shared by all events it wrote.
+    std::int64_t txid;
+    std::int64_t change_id;
+    boost::uuids::uuid user_id;
+    boost::uuids::uuid game_id;
+    GameStatus game_status;
+    // The entry was removed, game_status is its last status.
+    bool removed;
+
+    userver::storages::postgres::TimePointWithoutTz changed_at;
+};
+
+struct StatusCountPostgres
+{
+    GameStatus game_status;
+    std::int32_t entries;
+};
+
+struct DailyActivityPostgres
+{
+    userver::storages::postgres::TimePointWithoutTz day;
+    GameStatus game_status;
+    std::int32_t transitions;
+};
+
+} // namespace entities
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <boost/uuid/uuid.hpp>
+
+namespace utils {
+
+// Bloom filter over UUIDs. MayContain never returns false for an added key;
+// for other keys it returns true with roughly the configured probability
+// as long as no more than `capacity` keys were added.
+class BloomFilter
+{
+public:
+    BloomFilter(std::size_t capacity, double false_positive_rate);
+
+    void Add(const boost::uuids::uuid& key);
+    bool MayContain(const boost::uuids::uuid& key) const;
+
+    // Keys that set at least one new bit: adding a key twice counts it once,
+    // and a key that is a false positive is not counted at all.
+    std::size_t Size() const { return size_; }
+    std::size_t Capacity() const { return capacity_; }
+    std::size_t BitCount() const { return bit_count_; }
+
+private:
+    std::size_t capacity_;
+    std::size_t bit_count_;
+    std::size_t hash_count_;
+    std::size_t size_ = 0;
+    std::vector<std::uint64_t> words_;
+};
+
+} // namespace utils
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <userver/logging/log_extra.hpp>
+#include <userver/yaml_config/yaml_config.hpp>
+
+namespace utils {
+
+struct SlowRequestConfig
+{
+    bool enabled = false;
+    std::chrono::milliseconds threshold{ 100 };
+    // Fraction of requests that also collect executed queries; fast sampled
+    // requests are logged at debug level. Requests slower than the threshold
+    // are logged regardless of sampling.
+    double sample_rate = 1.0;
+};
+
+SlowRequestConfig Parse(const userver::yaml_config::YamlConfig& value,
+                        userver::formats::parse::To<SlowRequestConfig>);
+
+// Per-request collector of stage timings and executed queries. Every
+// request of an enabled config is timed, with stage timings kept in a fixed
+// array so that timing does not allocate. Sampled records also register
+// themselves as current for the task, so the repository can report queries
+// without threading the record through its interface. When the request
+// takes longer than the threshold, everything collected is written to the
+// log in one line on destruction.
+class SlowRequestRecord final
+{
+public:
+    class Stage final
+    {
+    public:
+        Stage(SlowRequestRecord* record, std::string_view name);
+        ~Stage();
+
+        Stage(const Stage&) = delete;
+        Stage& operator=(const Stage&) = delete;
+
+    private:
+        SlowRequestRecord* record_;
+        std::string_view name_;
+        std::chrono::steady_clock::time_point started_;
+    };
+
+    SlowRequestRecord(const SlowRequestConfig& config,
+                      std::string_view rpc_name);
+    ~SlowRequestRecord();
+
+    SlowRequestRecord(const SlowRequestRecord&) = delete;
+    SlowRequestRecord& operator=(const SlowRequestRecord&) = delete;
+
+    // Times the stage until the returned object goes out of scope.
+    Stage StartStage(std::string_view name);
+
+    void AddQuery(std::string_view statement, std::string params,
+                  std::size_t rows, std::chrono::microseconds duration);
+
+    // Time since construction, zero for a disabled config.
+    std::chrono::microseconds Elapsed() const;
+
+    // Sampled record of the current task, nullptr if there is none.
+    static SlowRequestRecord* Current();
+
+private:
+    struct StageTiming
+    {
+        std::string_view name;
+        std::chrono::microseconds duration;
+    };
+
+    struct QueryInfo
+    {
+        std::string statement;
+        std::string params;
+        std::size_t rows;
+        std::chrono::microseconds duration;
+    };
+
+    static constexpr std::size_t kMaxStages = 8;
+
+    void Flush() const;
+    userver::logging::LogExtra Details(
+        std::chrono::microseconds total) const;
+
+    std::string_view rpc_name_;
+    std::chrono::milliseconds threshold_;
+    bool enabled_;
+    bool sampled_;
+    SlowRequestRecord* previous_ = nullptr;
+    std::chrono::steady_clock::time_point started_;
+    std::array<StageTiming, kMaxStages> stages_{};
+    std::size_t stage_count_ = 0;
+    std::vector<QueryInfo> queries_;
+};
+
+} // namespace utils
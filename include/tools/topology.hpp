@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace utils {
+
+// Thread layout of the service derived from the number of available cores.
+struct ServiceTopology
+{
+    // grpc-server completion queues, each polled by its own thread
+    std::size_t grpc_completion_queues;
+    // grpc-task-processor: coroutines running LibraryService handlers and,
+    // unless db-task-processor is configured, repository queries
+    std::size_t grpc_worker_threads;
+    // main-task-processor: the HTTP listener and background components
+    std::size_t main_worker_threads;
+};
+
+ServiceTopology ComputeTopology(std::size_t cores);
+
+// Whole CPUs granted by a CFS quota, rounded down but at least one;
+// nullopt when the quota is unlimited (-1 or "max") or malformed.
+std::optional<std::size_t> CpuQuotaCores(std::int64_t quota_us,
+                                         std::int64_t period_us);
+// Parses the content of cgroup v2 cpu.max, "<quota> <period>".
+std::optional<std::size_t> ParseCgroupCpuMax(std::string_view content);
+
+std::size_t CapByCpuQuota(std::size_t cores,
+                          std::optional<std::size_t> quota_cores);
+
+// Cores the process may actually run on: the sched_getaffinity mask
+// (taskset, cpusets) capped by the cgroup CPU quota (container limits).
+// std::thread::hardware_concurrency() sees neither.
+std::size_t DetectAvailableCores();
+
+// Exports the topology for the current process as environment variables
+// read by configs/static_config.yaml. Variables that are already set are
+// left untouched, so deployments can still pin any of them explicitly.
+void ExportTopologyDefaults();
+
+} // namespace utils
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#include <boost/uuid/uuid.hpp>
+
+namespace utils {
+
+// Accepts only the canonical 8-4-4-4-12 hex form the service itself emits,
+// in either case. Neither function allocates or throws, so malformed ids
+// are rejected before any database work.
+bool IsValidUuid(std::string_view value) noexcept;
+
+std::optional<boost::uuids::uuid> ParseUuid(std::string_view value) noexcept;
+
+} // namespace utils
@@ -0,0 +1,64 @@
+-- Upgrades a database created by the original playhub.sql (playhub.library
+-- only) to the schema of postgresql/schemas/playhub.sql, keeping all rows.
+-- Safe to run more than once, and while the service is running.
+
+BEGIN;
+
+-- Tombstones, see RemoveLibraryEntry.
+ALTER TABLE playhub.library
+    ADD COLUMN IF NOT EXISTS deleted_at TIMESTAMP WITHOUT TIME ZONE;
+
+CREATE INDEX IF NOT EXISTS idx_library_tombstones ON playhub.library(deleted_at) WHERE deleted_at IS NOT NULL;
+
+-- Transactional outbox of library changes, see WatchLibraryChanges.
+CREATE TABLE IF NOT EXISTS playhub.library_changes (
+    change_id BIGSERIAL PRIMARY KEY,
+    shard INTEGER NOT NULL,
+    -- Writing transaction, the stream offset; see kGetLibraryChanges.
+    txid XID8 NOT NULL DEFAULT pg_current_xact_id(),
+
+    user_id UUID NOT NULL,
+    game_id UUID NOT NULL,
+    game_status playhub.game_status NOT NULL,
+    removed BOOLEAN NOT NULL DEFAULT FALSE,
+
+    changed_at TIMESTAMP WITHOUT TIME ZONE NOT NULL
+);
+
+CREATE INDEX IF NOT EXISTS idx_library_changes_shard ON playhub.library_changes(shard, txid);
+CREATE INDEX IF NOT EXISTS idx_library_changes_txid ON playhub.library_changes(txid);
+CREATE INDEX IF NOT EXISTS idx_library_changes_changed_at ON playhub.library_changes(changed_at);
+
+-- Analytics rollups maintained by the upsert, see GetLibraryAnalytics.
+CREATE TABLE IF NOT EXISTS playhub.library_status_counts (
+    user_id UUID NOT NULL,
+    game_status playhub.game_status NOT NULL,
+    entries INTEGER NOT NULL DEFAULT 0,
+
+    PRIMARY KEY (user_id, game_status)
+);
+
+CREATE TABLE IF NOT EXISTS playhub.library_daily_activity (
+    user_id UUID NOT NULL,
+    day DATE NOT NULL,
+    game_status playhub.game_status NOT NULL,
+    transitions INTEGER NOT NULL DEFAULT 0,
+
+    PRIMARY KEY (user_id, day, game_status)
+);
+
+-- Status counts are recomputed from the library. The lock waits for
+-- in-flight upserts and holds off new ones until the commit, so the counts
+-- are exact and later upserts adjust them from there. Past transitions
+-- are not recorded anywhere, so library_daily_activity starts empty.
+LOCK TABLE playhub.library IN SHARE MODE;
+
+DELETE FROM playhub.library_status_counts;
+
+INSERT INTO playhub.library_status_counts (user_id, game_status, entries)
+SELECT user_id, game_status, COUNT(*)
+FROM playhub.library
+WHERE deleted_at IS NULL
+GROUP BY user_id, game_status;
+
+COMMIT;
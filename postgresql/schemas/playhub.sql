@@ -1,9 +1,11 @@
+-- Creates the schema from scratch, dropping all data. Existing databases
+-- are upgraded with postgresql/migrations instead.
 DROP SCHEMA IF EXISTS playhub CASCADE;
 
 CREATE SCHEMA IF NOT EXISTS playhub;
 
 
-CREATE TYPE library.game_status AS ENUM (
+CREATE TYPE playhub.game_status AS ENUM (
     'unspecified',  
     'plan',         
     'playing',      
@@ -16,12 +18,52 @@ CREATE TABLE IF NOT EXISTS playhub.library (
     user_id UUID NOT NULL,
     game_id UUID NOT NULL,
 
-    game_status library.game_status NOT NULL DEFAULT 'unspecified',
+    game_status playhub.game_status NOT NULL DEFAULT 'unspecified',
 
     created_at TIMESTAMP WITHOUT TIME ZONE NOT NULL DEFAULT NOW(),
     updated_at TIMESTAMP WITHOUT TIME ZONE NOT NULL DEFAULT NOW(),
+    -- Set by removal; tombstones are deleted by the compaction task.
+    deleted_at TIMESTAMP WITHOUT TIME ZONE,
 
     PRIMARY KEY (user_id, game_id)
 );
 
-CREATE INDEX idx_library_entries_user_status ON library.library_entries(user_id, game_status);
+CREATE INDEX idx_library_entries_user_status ON playhub.library(user_id, game_status);
+CREATE INDEX idx_library_tombstones ON playhub.library(deleted_at) WHERE deleted_at IS NOT NULL;
+
+-- Transactional outbox of library changes, see WatchLibraryChanges.
+CREATE TABLE IF NOT EXISTS playhub.library_changes (
+    change_id BIGSERIAL PRIMARY KEY,
+    shard INTEGER NOT NULL,
+    -- Writing transaction, the stream offset; see kGetLibraryChanges.
+    txid XID8 NOT NULL DEFAULT pg_current_xact_id(),
+
+    user_id UUID NOT NULL,
+    game_id UUID NOT NULL,
+    game_status playhub.game_status NOT NULL,
+    removed BOOLEAN NOT NULL DEFAULT FALSE,
+
+    changed_at TIMESTAMP WITHOUT TIME ZONE NOT NULL
+);
+
+CREATE INDEX idx_library_changes_shard ON playhub.library_changes(shard, txid);
+CREATE INDEX idx_library_changes_txid ON playhub.library_changes(txid);
+CREATE INDEX idx_library_changes_changed_at ON playhub.library_changes(changed_at);
+
+-- Analytics rollups maintained by the upsert, see GetLibraryAnalytics.
+CREATE TABLE IF NOT EXISTS playhub.library_status_counts (
+    user_id UUID NOT NULL,
+    game_status playhub.game_status NOT NULL,
+    entries INTEGER NOT NULL DEFAULT 0,
+
+    PRIMARY KEY (user_id, game_status)
+);
+
+CREATE TABLE IF NOT EXISTS playhub.library_daily_activity (
+    user_id UUID NOT NULL,
+    day DATE NOT NULL,
+    game_status playhub.game_status NOT NULL,
+    transitions INTEGER NOT NULL DEFAULT 0,
+
+    PRIMARY KEY (user_id, day, game_status)
+);
@@ -0,0 +1,8 @@
+-- Libraries written before the migration, see migration_test.sh.
+INSERT INTO playhub.library (user_id, game_id, game_status) VALUES
+    ('11111111-1111-1111-1111-111111111111', '00000000-0000-0000-0000-000000000001', 'playing'),
+    ('11111111-1111-1111-1111-111111111111', '00000000-0000-0000-0000-000000000002', 'playing'),
+    ('11111111-1111-1111-1111-111111111111', '00000000-0000-0000-0000-000000000003', 'completed'),
+    ('22222222-2222-2222-2222-222222222222', '00000000-0000-0000-0000-000000000001', 'plan'),
+    ('22222222-2222-2222-2222-222222222222', '00000000-0000-0000-0000-000000000004', 'dropped'),
+    ('22222222-2222-2222-2222-222222222222', '00000000-0000-0000-0000-000000000005', 'dropped');
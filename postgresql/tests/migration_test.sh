@@ -0,0 +1,60 @@
+#!/usr/bin/env bash
+# Applies postgresql/migrations twice to a throwaway Postgres holding the
+# pre-migration schema and data, then checks that no rows are lost, that
+# the status counts match the library and that the result has exactly the
+# schema of postgresql/schemas/playhub.sql. Needs docker, see `make
+# migration-test`.
+set -euo pipefail
+
+cd "$(dirname "$0")/../.."
+source benchmarks/local_env.sh
+
+fail() {
+    echo "migration test: $*" >&2
+    exit 1
+}
+
+query() {
+    run_psql -d "${PG_DB}" -At -c "$1"
+}
+
+dump_schema() {
+    # Drops the per-dump \restrict keys of recent pg_dump versions.
+    docker exec "${PG_CONTAINER}" \
+        pg_dump -U "${PG_USER}" -d "$1" --schema-only --no-owner -n playhub \
+        | sed '/^\\\(un\)\?restrict /d'
+}
+
+trap stop_postgres EXIT
+start_postgres postgresql/tests/baseline_schema.sql
+run_psql -d "${PG_DB}" < postgresql/tests/baseline_data.sql
+
+for _ in 1 2; do
+    for migration in postgresql/migrations/*.sql; do
+        run_psql -d "${PG_DB}" < "${migration}" >/dev/null
+    done
+done
+
+[ "$(query 'SELECT COUNT(*) FROM playhub.library')" = 6 ] ||
+    fail "library rows were lost"
+
+mismatches=$(query "
+    SELECT COUNT(*)
+    FROM (
+        SELECT user_id, game_status, COUNT(*)::integer AS entries
+        FROM playhub.library
+        WHERE deleted_at IS NULL
+        GROUP BY user_id, game_status
+    ) AS expected
+    FULL JOIN playhub.library_status_counts AS counts
+        USING (user_id, game_status)
+    WHERE expected.entries IS DISTINCT FROM counts.entries")
+[ "${mismatches}" = 0 ] ||
+    fail "${mismatches} status counts differ from the library"
+
+run_psql -d postgres -c "CREATE DATABASE fresh_schema"
+run_psql -d fresh_schema < postgresql/schemas/playhub.sql >/dev/null
+diff -u <(dump_schema fresh_schema) <(dump_schema "${PG_DB}") ||
+    fail "migrated schema differs from postgresql/schemas/playhub.sql"
+
+echo "migration test passed"
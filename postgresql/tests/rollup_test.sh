@@ -0,0 +1,107 @@
+#!/usr/bin/env bash
+# Drives UpdateLibraryEntry of a locally started service against a fresh
+# Postgres, then checks the analytics rollups against the data they are
+# maintained from: the status counts against the live library, the daily
+# transitions against the status changes recorded in the outbox. Needs
+# docker, see `make rollup-test-PRESET`.
+#
+# Usage: postgresql/tests/rollup_test.sh [BUILD_DIR]
+set -euo pipefail
+
+cd "$(dirname "$0")/../.."
+source benchmarks/local_env.sh
+
+BUILD_DIR=${1:-build-release}
+
+fail() {
+    echo "rollup test: $*" >&2
+    exit 1
+}
+
+query() {
+    run_psql -d "${PG_DB}" -At -c "$1"
+}
+
+service_pid=
+cleanup() {
+    [ -n "${service_pid}" ] && kill "${service_pid}" 2>/dev/null || true
+    stop_postgres
+}
+trap cleanup EXIT
+
+start_postgres
+
+"${BUILD_DIR}/library-service" \
+    --config configs/static_config.yaml \
+    --config_vars configs/config_vars.testing.yaml &
+service_pid=$!
+wait_for_port "${GRPC_PORT}"
+
+# Few users with small libraries: most updates hit an existing entry, many
+# of them concurrently, and change its status.
+"${BUILD_DIR}/library-service-load-generator" \
+    --endpoint "localhost:${GRPC_PORT}" \
+    --output "${BUILD_DIR}/rollup_test.json" \
+    --mix 1:0:0 \
+    --users 20 \
+    --library-median 5 \
+    --library-max 20 \
+    --concurrency 8 \
+    --warmup 0 \
+    --duration 5 >/dev/null
+
+changes=$(query "
+    SELECT COUNT(*)
+    FROM (
+        SELECT game_status, LAG(game_status) OVER (
+            PARTITION BY user_id, game_id ORDER BY change_id) AS previous
+        FROM playhub.library_changes
+    ) AS events
+    WHERE game_status <> previous")
+[ "${changes}" -gt 0 ] ||
+    fail "the load changed no status, nothing was checked"
+
+mismatches=$(query "
+    SELECT COUNT(*)
+    FROM (
+        SELECT user_id, game_status, COUNT(*)::integer AS entries
+        FROM playhub.library
+        WHERE deleted_at IS NULL
+        GROUP BY user_id, game_status
+    ) AS expected
+    FULL JOIN playhub.library_status_counts AS counts
+        USING (user_id, game_status)
+    WHERE COALESCE(expected.entries, 0) IS DISTINCT FROM counts.entries")
+[ "${mismatches}" = 0 ] ||
+    fail "${mismatches} status counts differ from the library"
+
+# Events of one entry are written under its row lock, so change_id orders
+# them. An event enters its status when it is the first one of the entry,
+# follows a removal or changes the status.
+mismatches=$(query "
+    SELECT COUNT(*)
+    FROM (
+        SELECT user_id, game_status, COUNT(*)::integer AS transitions
+        FROM (
+            SELECT user_id, game_status, removed,
+                LAG(game_status) OVER entry AS previous_status,
+                LAG(removed) OVER entry AS previous_removed
+            FROM playhub.library_changes
+            WINDOW entry AS (PARTITION BY user_id, game_id ORDER BY change_id)
+        ) AS events
+        WHERE NOT removed
+            AND (previous_status IS NULL
+                OR previous_removed
+                OR previous_status <> game_status)
+        GROUP BY user_id, game_status
+    ) AS expected
+    FULL JOIN (
+        SELECT user_id, game_status, SUM(transitions)::integer AS transitions
+        FROM playhub.library_daily_activity
+        GROUP BY user_id, game_status
+    ) AS activity USING (user_id, game_status)
+    WHERE expected.transitions IS DISTINCT FROM activity.transitions")
+[ "${mismatches}" = 0 ] ||
+    fail "${mismatches} daily transition rollups differ from the outbox"
+
+echo "rollup test passed (${changes} status changes)"
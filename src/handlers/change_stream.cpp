@@ -0,0 +1,25 @@
+#include <handlers/change_stream.hpp>
+
+#include <stdexcept>
+
+namespace library_service {
+
+ChangeStreamConfig Parse(const userver::yaml_config::YamlConfig& value,
+                         userver::formats::parse::To<ChangeStreamConfig>)
+{
+    ChangeStreamConfig config;
+    config.shards = value["shards"].As<std::int32_t>(config.shards);
+    config.batch_size =
+        value["batch-size"].As<std::int32_t>(config.batch_size);
+    config.poll_interval = std::chrono::milliseconds(
+        value["poll-interval-ms"].As<std::int64_t>(
+            config.poll_interval.count()));
+
+    if (config.shards <= 0 || config.batch_size <= 0)
+        throw std::runtime_error(
+            "change-stream shards and batch-size must be positive");
+
+    return config;
+}
+
+} // namespace library_service
@@ -0,0 +1,95 @@
+#include <handlers/compression_policy.hpp>
+
+#include <stdexcept>
+#include <string>
+
+#include <userver/utils/statistics/writer.hpp>
+
+namespace library_service {
+
+namespace {
+
+void AddRate(userver::utils::statistics::RateCounter& counter,
+             std::size_t value)
+{
+    counter += userver::utils::statistics::Rate{ value };
+}
+
+} // namespace
+
+CompressionConfig Parse(const userver::yaml_config::YamlConfig& value,
+                        userver::formats::parse::To<CompressionConfig>)
+{
+    CompressionConfig config;
+    config.enabled = value["enabled"].As<bool>(config.enabled);
+    config.min_size_bytes =
+        value["min-size-bytes"].As<std::size_t>(config.min_size_bytes);
+
+    const auto algorithm = value["algorithm"].As<std::string>("gzip");
+    if (algorithm == "gzip")
+    {
+        config.algorithm = GRPC_COMPRESS_GZIP;
+    }
+    else if (algorithm == "deflate")
+    {
+        config.algorithm = GRPC_COMPRESS_DEFLATE;
+    }
+    else
+    {
+        throw std::runtime_error("Unsupported compression algorithm: " +
+                                 algorithm);
+    }
+
+    return config;
+}
+
+void DumpMetric(userver::utils::statistics::Writer& writer,
+                const CompressionMetrics& metrics)
+{
+    writer["compressed"] = metrics.compressed;
+    writer["skipped"]["small"] = metrics.skipped_small;
+    writer["compressed-input-bytes"] = metrics.compressed_input_bytes;
+}
+
+const userver::utils::statistics::MetricTag<CompressionMetrics>
+    kCompressionMetricsTag{ "library.compression" };
+
+CompressionPolicy::CompressionPolicy(CompressionConfig config,
+                                     CompressionMetrics& metrics)
+    : config_(config), metrics_(&metrics)
+{}
+
+CompressionDecision CompressionPolicy::Decide(std::size_t message_size) const
+{
+    if (!config_.enabled)
+        return CompressionDecision::kDisabled;
+
+    if (message_size < config_.min_size_bytes)
+        return CompressionDecision::kSkipSmall;
+
+    return CompressionDecision::kCompress;
+}
+
+void CompressionPolicy::Apply(grpc::ServerContext& context,
+                              const google::protobuf::Message& response) const
+{
+    if (!config_.enabled)
+        return;
+
+    const auto message_size = response.ByteSizeLong();
+    switch (Decide(message_size))
+    {
+    case CompressionDecision::kCompress:
+        context.set_compression_algorithm(config_.algorithm);
+        ++metrics_->compressed;
+        AddRate(metrics_->compressed_input_bytes, message_size);
+        break;
+    case CompressionDecision::kSkipSmall:
+        ++metrics_->skipped_small;
+        break;
+    case CompressionDecision::kDisabled:
+        break;
+    }
+}
+
+} // namespace library_service
@@ -1,39 +1,53 @@
 #include <handlers/library_grpc.hpp>
 
+#include <stdexcept>
+
+#include <userver/components/statistics_storage.hpp>
 #include <userver/storages/postgres/component.hpp>
+#include <userver/engine/sleep.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/tracing/span.hpp>
+#include <userver/ugrpc/server/exceptions.hpp>
+#include <userver/utils/statistics/metrics_storage.hpp>
 
 #include <boost/uuid/uuid_io.hpp>
+#include <handlers/request_validation.hpp>
 #include <tools/utils.hpp>
+#include <tools/uuid.hpp>
 
 namespace library_service {
 
 LibraryService::LibraryService(std::string prefix,
-                               const pg::ILibraryRepository& manager)
-    : prefix_(std::move(prefix)), pg_manager_(manager)
-{}
+                               const pg::ILibraryRepository& manager,
+                               LibraryServiceOptions options)
+    : prefix_(std::move(prefix)), pg_manager_(manager),
+      compression_(options.compression),
+      slow_request_(options.slow_request),
+      membership_cache_(options.membership_cache, manager),
+      change_stream_(options.change_stream),
+      purge_batch_size_(options.purge_batch_size)
+{
+    if (purge_batch_size_ <= 0)
+        throw std::runtime_error("purge-batch-size must be positive");
+}
 
 ::library::LibraryServiceBase::UpdateLibraryEntryResult
 LibraryService::UpdateLibraryEntry(
     CallContext& context, ::library::UpdateLibraryEntryRequest&& request)
 {
-    if (request.user_id().empty())
-    {
-        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
-                            "user_id cannot be empty");
-    }
-    if (request.game_id().empty())
-    {
-        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
-                            "game_id cannot be empty");
-    }
+    if (auto status = Validate(request); !status.ok())
+        return status;
+
+    utils::SlowRequestRecord slow_request(slow_request_, "UpdateLibraryEntry");
 
     try
     {
-        std::string_view db_status_str =
-            utils::GameStatusToString(request.status());
-
-        const auto kUpsertedLibraryEntry = pg_manager_.CreateLibraryEntry(
-            request.user_id(), request.game_id(), db_status_str);
+        const auto kUpsertedLibraryEntry = [&] {
+            const auto stage = slow_request.StartStage("db");
+            return pg_manager_.CreateLibraryEntry(
+                request.user_id(), request.game_id(),
+                entities::FromProto(request.status()));
+        }();
 
         if (kUpsertedLibraryEntry.user_id.is_nil())
         {
@@ -45,8 +59,14 @@ LibraryService::UpdateLibraryEntry(
                                 "Failed to update library entry");
         }
 
+        membership_cache_.Add(kUpsertedLibraryEntry.user_id,
+                              kUpsertedLibraryEntry.game_id);
+
         ::library::UpdateLibraryEntryResponse response;
-        FillLibraryEntry(kUpsertedLibraryEntry, *response.mutable_entry());
+        {
+            const auto stage = slow_request.StartStage("serialize");
+            FillLibraryEntry(kUpsertedLibraryEntry, *response.mutable_entry());
+        }
 
         return response;
     }
@@ -62,22 +82,36 @@ LibraryService::UpdateLibraryEntry(
 LibraryService::GetUserLibrary(CallContext& context,
                                ::library::GetUserLibraryRequest&& request)
 {
-    if (request.user_id().empty())
-        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
-                            "user_id cannot be empty");
+    if (auto status = Validate(request); !status.ok())
+        return status;
+
+    utils::SlowRequestRecord slow_request(slow_request_, "GetUserLibrary");
 
     try
     {
-        const auto db_entries = pg_manager_.GetLibraryEntries(
-            request.user_id(), request.limit(), request.offset());
+        const auto db_entries = [&] {
+            const auto stage = slow_request.StartStage("db");
+            return pg_manager_.GetLibraryEntries(
+                request.user_id(), request.limit(), request.offset());
+        }();
 
         ::library::GetUserLibraryResponse response;
-        response.mutable_entries()->Reserve(db_entries.size());
+        {
+            userver::tracing::Span span{ "fill_library_entries" };
+            span.AddTag("entries", db_entries.size());
+            const auto stage = slow_request.StartStage("serialize");
+
+            response.mutable_entries()->Reserve(db_entries.size());
+            for (const auto& db_entry : db_entries)
+            {
+                auto* proto_entry = response.add_entries();
+                FillLibraryEntry(db_entry, *proto_entry);
+            }
+        }
 
-        for (const auto& db_entry : db_entries)
         {
-            auto* proto_entry = response.add_entries();
-            FillLibraryEntry(db_entry, *proto_entry);
+            const auto stage = slow_request.StartStage("compression");
+            compression_.Apply(context.GetServerContext(), response);
         }
 
         return response;
@@ -93,13 +127,17 @@ LibraryService::GetUserLibrary(CallContext& context,
 LibraryService::GetLibraryStats(CallContext& context,
                                 ::library::GetLibraryStatsRequest&& request)
 {
-    if (request.user_id().empty())
-        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
-                            "user_id cannot be empty");
+    if (auto status = Validate(request); !status.ok())
+        return status;
+
+    utils::SlowRequestRecord slow_request(slow_request_, "GetLibraryStats");
 
     try
     {
-        const auto count = pg_manager_.GetLibraryStats(request.user_id());
+        const auto count = [&] {
+            const auto stage = slow_request.StartStage("db");
+            return pg_manager_.GetLibraryStats(request.user_id());
+        }();
 
         ::library::GetLibraryStatsResponse response;
         response.set_count_library_entries(count);
@@ -114,15 +152,266 @@ LibraryService::GetLibraryStats(CallContext& context,
     }
 }
 
+#ifdef LIBRARY_SERVICE_PROTO_V2
+::library::LibraryServiceBase::GetLibraryEntryResult
+LibraryService::GetLibraryEntry(CallContext& context,
+                                ::library::GetLibraryEntryRequest&& request)
+{
+    if (auto status = Validate(request); !status.ok())
+        return status;
+
+    const auto user_id = utils::ParseUuid(request.user_id());
+    const auto game_id = utils::ParseUuid(request.game_id());
+
+    utils::SlowRequestRecord slow_request(slow_request_, "GetLibraryEntry");
+
+    try
+    {
+        ::library::GetLibraryEntryResponse response;
+
+        {
+            const auto stage = slow_request.StartStage("bloom_filter");
+            if (!membership_cache_.MayContain(*user_id, *game_id))
+                return response;
+        }
+
+        const auto db_entry = [&] {
+            const auto stage = slow_request.StartStage("db");
+            return pg_manager_.GetLibraryEntry(request.user_id(),
+                                               request.game_id());
+        }();
+
+        if (db_entry)
+            FillLibraryEntry(*db_entry, *response.mutable_entry());
+
+        return response;
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR() << "Failed to get library entry for user "
+                    << request.user_id() << ", game " << request.game_id()
+                    << ": " << e.what();
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Database error");
+    }
+}
+
+::library::LibraryServiceBase::RemoveLibraryEntryResult
+LibraryService::RemoveLibraryEntry(
+    CallContext& context, ::library::RemoveLibraryEntryRequest&& request)
+{
+    if (auto status = Validate(request); !status.ok())
+        return status;
+
+    utils::SlowRequestRecord slow_request(slow_request_, "RemoveLibraryEntry");
+
+    try
+    {
+        // The membership filters keep the game: a false positive only costs
+        // a GetLibraryEntry query that finds nothing.
+        const auto removed = [&] {
+            const auto stage = slow_request.StartStage("db");
+            return pg_manager_.RemoveLibraryEntry(request.user_id(),
+                                                  request.game_id());
+        }();
+
+        ::library::RemoveLibraryEntryResponse response;
+        response.set_removed(removed);
+
+        return response;
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR() << "Failed to remove library entry for user "
+                    << request.user_id() << ", game " << request.game_id()
+                    << ": " << e.what();
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Database error");
+    }
+}
+
+::library::LibraryServiceBase::PurgeUserLibraryResult
+LibraryService::PurgeUserLibrary(CallContext& context,
+                                 ::library::PurgeUserLibraryRequest&& request)
+{
+    if (auto status = Validate(request); !status.ok())
+        return status;
+
+    utils::SlowRequestRecord slow_request(slow_request_, "PurgeUserLibrary");
+
+    try
+    {
+        // Batches commit one by one, so a failed purge leaves part of the
+        // library removed; retrying it removes the rest.
+        const auto removed = [&] {
+            const auto stage = slow_request.StartStage("db");
+
+            std::int32_t total = 0;
+            while (true)
+            {
+                const auto batch = pg_manager_.PurgeUserLibrary(
+                    request.user_id(), purge_batch_size_);
+                total += batch;
+
+                if (batch < purge_batch_size_)
+                    return total;
+            }
+        }();
+
+        ::library::PurgeUserLibraryResponse response;
+        response.set_removed_entries(removed);
+
+        return response;
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR() << "Failed to purge library of user " << request.user_id()
+                    << ": " << e.what();
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Database error");
+    }
+}
+
+::library::LibraryServiceBase::WatchLibraryChangesResult
+LibraryService::WatchLibraryChanges(
+    CallContext& context, ::library::WatchLibraryChangesRequest&& request,
+    WatchLibraryChangesWriter& writer)
+{
+    if (auto status = Validate(request); !status.ok())
+        return status;
+
+    if (request.shard() >= change_stream_.shards)
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                            "shard must be in [0, " +
+                                std::to_string(change_stream_.shards) + ")");
+
+    // Offset of the last transaction whose events were all written.
+    auto offset = request.after_offset();
+
+    try
+    {
+        while (!userver::engine::current_task::ShouldCancel())
+        {
+            const auto changes = pg_manager_.GetLibraryChanges(
+                request.shard(), offset, change_stream_.batch_size);
+
+            std::int32_t transactions = 0;
+            for (std::size_t i = 0; i < changes.size(); ++i)
+            {
+                const auto& change = changes[i];
+                if (i == 0 || change.txid != changes[i - 1].txid)
+                    ++transactions;
+
+                ::library::LibraryChangeEvent event;
+                event.set_offset(change.txid);
+                event.set_user_id(boost::uuids::to_string(change.user_id));
+                event.set_game_id(boost::uuids::to_string(change.game_id));
+                event.set_status(entities::ToProto(change.game_status));
+                event.set_removed(change.removed);
+                *event.mutable_changed_at() =
+                    utils::TimePointToProtobuf(change.changed_at);
+
+                writer.Write(event);
+            }
+
+            // A batch never splits a transaction, so every event of the
+            // last one has been written.
+            if (!changes.empty())
+                offset = changes.back().txid;
+
+            // A full batch means the subscriber is behind, keep reading.
+            if (transactions < change_stream_.batch_size)
+                userver::engine::InterruptibleSleepFor(
+                    change_stream_.poll_interval);
+        }
+    }
+    catch (const userver::ugrpc::server::RpcInterruptedError&)
+    {
+        throw;
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR() << "Failed to stream library changes of shard "
+                    << request.shard() << " after offset " << offset << ": "
+                    << e.what();
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Database error");
+    }
+
+    return grpc::Status(grpc::StatusCode::CANCELLED,
+                        "Stream cancelled, resume after offset " +
+                            std::to_string(offset));
+}
+
+::library::LibraryServiceBase::GetLibraryAnalyticsResult
+LibraryService::GetLibraryAnalytics(
+    CallContext& context, ::library::GetLibraryAnalyticsRequest&& request)
+{
+    if (auto status = Validate(request); !status.ok())
+        return status;
+
+    const auto days =
+        request.days() == 0 ? kDefaultAnalyticsDays : request.days();
+
+    utils::SlowRequestRecord slow_request(slow_request_,
+                                          "GetLibraryAnalytics");
+
+    try
+    {
+        const auto [status_counts, activity] = [&] {
+            const auto stage = slow_request.StartStage("db");
+            return std::make_pair(
+                pg_manager_.GetStatusCounts(request.user_id()),
+                pg_manager_.GetDailyActivity(request.user_id(), days));
+        }();
+
+        ::library::GetLibraryAnalyticsResponse response;
+
+        std::int32_t total = 0;
+        std::int32_t completed = 0;
+        for (const auto& status_count : status_counts)
+        {
+            auto* proto = response.add_status_counts();
+            proto->set_status(entities::ToProto(status_count.game_status));
+            proto->set_count(status_count.entries);
+
+            total += status_count.entries;
+            if (status_count.game_status == entities::GameStatus::kCompleted)
+                completed += status_count.entries;
+        }
+
+        response.set_total_entries(total);
+        response.set_completion_rate(
+            total > 0 ? static_cast<double>(completed) / total : 0.0);
+
+        response.mutable_activity()->Reserve(activity.size());
+        for (const auto& day : activity)
+        {
+            auto* proto = response.add_activity();
+            *proto->mutable_day() = utils::TimePointToProtobuf(day.day);
+            proto->set_status(entities::ToProto(day.game_status));
+            proto->set_transitions(day.transitions);
+        }
+
+        return response;
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR() << "Failed to get analytics for user " << request.user_id()
+                    << ": " << e.what();
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Database error");
+    }
+}
+#endif
+
+void LibraryService::RefreshMembershipCache()
+{
+    membership_cache_.Refresh();
+}
+
 void LibraryService::FillLibraryEntry(const entities::LibraryPostgres& db_entry,
                                       ::library::LibraryEntry& proto)
 {
     proto.set_user_id(boost::uuids::to_string(db_entry.user_id));
     proto.set_game_id(boost::uuids::to_string(db_entry.game_id));
 
-    auto proto_status = static_cast<::library::GameStatus>(
-        static_cast<int>(db_entry.game_status));
-    proto.set_status(proto_status);
+    proto.set_status(entities::ToProto(db_entry.game_status));
 
     *proto.mutable_created_at() =
         utils::TimePointToProtobuf(db_entry.created_at);
@@ -137,10 +426,49 @@ LibraryServiceComponent::LibraryServiceComponent(
       pg_manager_(context
                       .FindComponent<userver::components::Postgres>(
                           "playhub-library-db")
-                      .GetCluster()),
-      service_(config["library-prefix"].As<std::string>(), pg_manager_)
+                      .GetCluster(),
+                  config.HasMember("db-task-processor")
+                      ? &context.GetTaskProcessor(
+                            config["db-task-processor"].As<std::string>())
+                      : nullptr,
+                  config["change-stream"].As<ChangeStreamConfig>({}).shards),
+      service_(
+          config["library-prefix"].As<std::string>(), pg_manager_,
+          LibraryServiceOptions{
+              CompressionPolicy(
+                  config["compression"].As<CompressionConfig>({}),
+                  context
+                      .FindComponent<userver::components::StatisticsStorage>()
+                      .GetMetricsStorage()
+                      ->GetMetric(kCompressionMetricsTag)),
+              config["slow-request"].As<utils::SlowRequestConfig>({}),
+              config["membership-cache"].As<MembershipCacheConfig>({}),
+              config["change-stream"].As<ChangeStreamConfig>({}),
+              config["purge-batch-size"].As<std::int32_t>(1000) })
 {
     RegisterService(service_);
+
+    const auto membership =
+        config["membership-cache"].As<MembershipCacheConfig>({});
+    if (membership.enabled)
+    {
+        membership_task_.Start(
+            "library-membership-refresh",
+            userver::utils::PeriodicTask::Settings(membership.refresh_period),
+            [this] { service_.RefreshMembershipCache(); });
+    }
+
+    const auto compaction =
+        config["tombstone-compaction"].As<TombstoneCompactionConfig>({});
+    if (compaction.enabled)
+    {
+        compaction_task_.Start(
+            "library-tombstone-compaction",
+            userver::utils::PeriodicTask::Settings(compaction.period),
+            [compactor = TombstoneCompactor(compaction, pg_manager_)] {
+                compactor.Run();
+            });
+    }
 }
 
 userver::yaml_config::Schema LibraryServiceComponent::GetStaticConfigSchema()
@@ -155,6 +483,125 @@ userver::yaml_config::Schema LibraryServiceComponent::GetStaticConfigSchema()
                 library-prefix:
                     type: string
                     description: library prefix
+                compression:
+                    type: object
+                    description: per-call compression of large responses
+                    additionalProperties: false
+                    properties:
+                        enabled:
+                            type: boolean
+                            description: compress responses at all
+                        algorithm:
+                            type: string
+                            description: gzip or deflate
+                        min-size-bytes:
+                            type: integer
+                            description: responses below this size are not compressed
+                slow-request:
+                    type: object
+                    description: log of requests slower than a threshold
+                    additionalProperties: false
+                    properties:
+                        enabled:
+                            type: boolean
+                            description: collect and log slow requests
+                        threshold-ms:
+                            type: integer
+                            description: requests slower than this are logged
+                        sample-rate:
+                            type: number
+                            description: |
+                                fraction of requests that also collect query
+                                details; slow requests are always logged
+                membership-cache:
+                    type: object
+                    description: |
+                        per-user Bloom filters answering "not in library"
+                        for GetLibraryEntry without a database query, kept
+                        current by following the change outbox
+                    additionalProperties: false
+                    properties:
+                        enabled:
+                            type: boolean
+                            description: use the filters at all
+                        max-users:
+                            type: integer
+                            description: number of users with a cached filter
+                        false-positive-rate:
+                            type: number
+                            description: target false positive rate
+                        refresh-period-ms:
+                            type: integer
+                            description: |
+                                period of following the outbox and building
+                                filters for newly looked up users
+                        max-staleness-ms:
+                            type: integer
+                            description: |
+                                filters are not trusted once the outbox has
+                                not been followed for this long
+                        batch-size:
+                            type: integer
+                            description: outbox events read per query
+                        max-builds:
+                            type: integer
+                            description: filters built per refresh
+                change-stream:
+                    type: object
+                    description: WatchLibraryChanges outbox streaming
+                    additionalProperties: false
+                    properties:
+                        shards:
+                            type: integer
+                            description: |
+                                number of outbox shards, changing it remaps
+                                users to shards for new events
+                        batch-size:
+                            type: integer
+                            description: transactions read from the outbox at once
+                        poll-interval-ms:
+                            type: integer
+                            description: outbox poll period of an idle stream
+                tombstone-compaction:
+                    type: object
+                    description: |
+                        background deletion of removed library entries,
+                        in rate-limited batches
+                    additionalProperties: false
+                    properties:
+                        enabled:
+                            type: boolean
+                            description: run the compaction task at all
+                        retention-hours:
+                            type: integer
+                            description: removed entries are kept this long
+                        period-ms:
+                            type: integer
+                            description: pause between compaction runs
+                        batch-size:
+                            type: integer
+                            description: tombstones deleted per statement
+                        max-batches:
+                            type: integer
+                            description: statements per compaction run
+                        batch-pause-ms:
+                            type: integer
+                            description: pause between statements of a run
+                        outbox-retention-hours:
+                            type: integer
+                            description: |
+                                WatchLibraryChanges events are kept this long,
+                                subscribers further behind lose events
+                purge-batch-size:
+                    type: integer
+                    description: |
+                        entries removed per statement by PurgeUserLibrary,
+                        bounds row locks and dead tuples per transaction
+                db-task-processor:
+                    type: string
+                    description: |
+                        task processor for repository queries, defaults to
+                        the service task processor
                 database:
                     type: object
                     description: Database connection settings
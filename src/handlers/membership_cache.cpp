@@ -0,0 +1,262 @@
+#include <handlers/membership_cache.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+#include <boost/uuid/uuid_io.hpp>
+
+#include <userver/engine/task/cancel.hpp>
+#include <userver/logging/log.hpp>
+
+namespace library_service {
+
+namespace {
+
+// Headroom for games added after the build before the filter is rebuilt.
+std::size_t FilterCapacity(std::size_t size)
+{
+    return size + std::max<std::size_t>(size / 2, 32);
+}
+
+} // namespace
+
+MembershipCacheConfig Parse(const userver::yaml_config::YamlConfig& value,
+                            userver::formats::parse::To<MembershipCacheConfig>)
+{
+    MembershipCacheConfig config;
+    config.enabled = value["enabled"].As<bool>(config.enabled);
+    config.max_users = value["max-users"].As<std::size_t>(config.max_users);
+    config.false_positive_rate =
+        value["false-positive-rate"].As<double>(config.false_positive_rate);
+    config.refresh_period = std::chrono::milliseconds(
+        value["refresh-period-ms"].As<std::int64_t>(
+            config.refresh_period.count()));
+    config.max_staleness = std::chrono::milliseconds(
+        value["max-staleness-ms"].As<std::int64_t>(
+            config.max_staleness.count()));
+    config.batch_size =
+        value["batch-size"].As<std::int32_t>(config.batch_size);
+    config.max_builds =
+        value["max-builds"].As<std::int32_t>(config.max_builds);
+
+    if (config.batch_size <= 0 || config.max_builds <= 0)
+        throw std::runtime_error(
+            "membership-cache batch-size and max-builds must be positive");
+
+    return config;
+}
+
+LibraryMembershipCache::LibraryMembershipCache(
+    MembershipCacheConfig config, const pg::ILibraryRepository& repository)
+    : config_(config), repository_(repository),
+      filters_(std::max<std::size_t>(config.max_users, 1))
+{}
+
+bool LibraryMembershipCache::MayContain(const boost::uuids::uuid& user_id,
+                                        const boost::uuids::uuid& game_id)
+{
+    if (!config_.enabled)
+        return true;
+
+    std::lock_guard lock(mutex_);
+
+    auto* entry = filters_.Get(user_id);
+    if (!entry)
+    {
+        filters_.Put(user_id, Entry{});
+        entry = filters_.Get(user_id);
+    }
+
+    if (!entry->filter)
+    {
+        if (!entry->queued && pending_builds_.size() < config_.max_users)
+        {
+            entry->queued = true;
+            pending_builds_.push_back(user_id);
+        }
+        return true;
+    }
+
+    if (!synced_at_ || std::chrono::steady_clock::now() - *synced_at_ >=
+                           config_.max_staleness)
+        return true;
+
+    return entry->filter->MayContain(game_id);
+}
+
+void LibraryMembershipCache::Add(const boost::uuids::uuid& user_id,
+                                 const boost::uuids::uuid& game_id)
+{
+    if (!config_.enabled)
+        return;
+
+    std::lock_guard lock(mutex_);
+    auto* entry = filters_.Get(user_id);
+    if (!entry)
+        return;
+
+    if (!entry->filter)
+    {
+        entry->dirty = true;
+        return;
+    }
+
+    AddLocked(*entry, user_id, game_id);
+}
+
+void LibraryMembershipCache::Refresh()
+{
+    if (!config_.enabled)
+        return;
+
+    try
+    {
+        FollowChanges();
+    }
+    catch (const std::exception& e)
+    {
+        LOG_WARNING() << "Failed to follow library changes for membership "
+                         "filters: "
+                      << e.what();
+    }
+
+    BuildQueued();
+}
+
+// Events are read by transaction id rather than by offset: every
+// transaction at or above the xmin of the previous pass may have committed
+// since, so their events are read again and re-adding a game is a no-op.
+// Transactions below that xmin had finished before the previous pass read
+// the outbox and were applied by it.
+void LibraryMembershipCache::FollowChanges()
+{
+    const auto started = std::chrono::steady_clock::now();
+    const auto xmin = repository_.GetOutboxXmin();
+
+    if (applied_xmin_)
+    {
+        std::int64_t after = 0;
+        while (true)
+        {
+            if (userver::engine::current_task::ShouldCancel())
+                return;
+
+            const auto changes = repository_.GetLibraryChangesSince(
+                *applied_xmin_, after, config_.batch_size);
+
+            {
+                std::lock_guard lock(mutex_);
+                for (const auto& change : changes)
+                {
+                    // A removed game may stay in the filter, which only
+                    // costs a database query.
+                    if (change.removed)
+                        continue;
+
+                    auto* entry = filters_.Get(change.user_id);
+                    if (entry && entry->filter)
+                        AddLocked(*entry, change.user_id, change.game_id);
+                }
+            }
+
+            if (changes.size() < static_cast<std::size_t>(config_.batch_size))
+                break;
+
+            after = changes.back().change_id;
+        }
+    }
+
+    applied_xmin_ = xmin;
+
+    std::lock_guard lock(mutex_);
+    synced_at_ = started;
+}
+
+void LibraryMembershipCache::BuildQueued()
+{
+    std::vector<boost::uuids::uuid> users;
+    {
+        std::lock_guard lock(mutex_);
+        const auto count = std::min(
+            pending_builds_.size(),
+            static_cast<std::size_t>(config_.max_builds));
+        users.assign(pending_builds_.begin(),
+                     pending_builds_.begin() + count);
+        pending_builds_.erase(pending_builds_.begin(),
+                              pending_builds_.begin() + count);
+    }
+
+    for (const auto& user_id : users)
+    {
+        if (userver::engine::current_task::ShouldCancel())
+            return;
+
+        try
+        {
+            Build(user_id);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_WARNING() << "Failed to build membership filter for user "
+                          << boost::uuids::to_string(user_id) << ": "
+                          << e.what();
+
+            // Queued again by its next lookup.
+            std::lock_guard lock(mutex_);
+            if (auto* entry = filters_.Get(user_id))
+                entry->queued = false;
+        }
+    }
+}
+
+// Events of transactions that commit after the game ids are read have a
+// txid at or above the xmin taken by the preceding FollowChanges(), so the
+// next pass applies them to the new filter.
+void LibraryMembershipCache::Build(const boost::uuids::uuid& user_id)
+{
+    const auto game_ids =
+        repository_.GetLibraryGameIds(boost::uuids::to_string(user_id));
+
+    utils::BloomFilter filter(FilterCapacity(game_ids.size()),
+                              config_.false_positive_rate);
+    for (const auto& game_id : game_ids)
+        filter.Add(game_id);
+
+    std::lock_guard lock(mutex_);
+    auto* entry = filters_.Get(user_id);
+    if (!entry || entry->filter)
+        return;
+
+    if (entry->dirty)
+    {
+        entry->dirty = false;
+        pending_builds_.push_back(user_id);
+        return;
+    }
+
+    entry->queued = false;
+    entry->filter.emplace(std::move(filter));
+}
+
+void LibraryMembershipCache::AddLocked(Entry& entry,
+                                       const boost::uuids::uuid& user_id,
+                                       const boost::uuids::uuid& game_id)
+{
+    if (entry.filter->Size() < entry.filter->Capacity())
+    {
+        entry.filter->Add(game_id);
+        return;
+    }
+
+    // Rebuilt with room for the grown library.
+    entry.filter.reset();
+    entry.dirty = false;
+    if (!entry.queued)
+    {
+        entry.queued = true;
+        pending_builds_.push_back(user_id);
+    }
+}
+
+} // namespace library_service
@@ -0,0 +1,112 @@
+#include <handlers/request_validation.hpp>
+
+#include <string>
+#include <string_view>
+
+#include <tools/uuid.hpp>
+
+namespace library_service {
+
+namespace {
+
+grpc::Status InvalidArgument(std::string message)
+{
+    return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, std::move(message));
+}
+
+grpc::Status ValidateUuid(std::string_view value, std::string_view field)
+{
+    if (value.empty())
+        return InvalidArgument(std::string(field) + " cannot be empty");
+
+    if (!utils::IsValidUuid(value))
+        return InvalidArgument(std::string(field) + " must be a UUID");
+
+    return grpc::Status::OK;
+}
+
+grpc::Status ValidateUserAndGame(std::string_view user_id,
+                                 std::string_view game_id)
+{
+    if (auto status = ValidateUuid(user_id, "user_id"); !status.ok())
+        return status;
+
+    return ValidateUuid(game_id, "game_id");
+}
+
+} // namespace
+
+grpc::Status Validate(const ::library::UpdateLibraryEntryRequest& request)
+{
+    if (auto status = ValidateUserAndGame(request.user_id(), request.game_id());
+        !status.ok())
+        return status;
+
+    // proto3 lets unknown enum values through, they must not reach the
+    // playhub.game_status cast.
+    if (!::library::GameStatus_IsValid(request.status()))
+        return InvalidArgument("status is not a known GameStatus");
+
+    return grpc::Status::OK;
+}
+
+grpc::Status Validate(const ::library::GetUserLibraryRequest& request)
+{
+    if (auto status = ValidateUuid(request.user_id(), "user_id");
+        !status.ok())
+        return status;
+
+    if (request.limit() < 0 || request.offset() < 0)
+        return InvalidArgument("limit and offset cannot be negative");
+
+    return grpc::Status::OK;
+}
+
+grpc::Status Validate(const ::library::GetLibraryStatsRequest& request)
+{
+    return ValidateUuid(request.user_id(), "user_id");
+}
+
+#ifdef LIBRARY_SERVICE_PROTO_V2
+grpc::Status Validate(const ::library::GetLibraryEntryRequest& request)
+{
+    return ValidateUserAndGame(request.user_id(), request.game_id());
+}
+
+grpc::Status Validate(const ::library::RemoveLibraryEntryRequest& request)
+{
+    return ValidateUserAndGame(request.user_id(), request.game_id());
+}
+
+grpc::Status Validate(const ::library::PurgeUserLibraryRequest& request)
+{
+    return ValidateUuid(request.user_id(), "user_id");
+}
+
+grpc::Status Validate(const ::library::GetLibraryAnalyticsRequest& request)
+{
+    if (auto status = ValidateUuid(request.user_id(), "user_id");
+        !status.ok())
+        return status;
+
+    if (request.days() < 0 || request.days() > kMaxAnalyticsDays)
+        return InvalidArgument("days must be in [0, " +
+                               std::to_string(kMaxAnalyticsDays) + "]");
+
+    return grpc::Status::OK;
+}
+
+grpc::Status Validate(const ::library::WatchLibraryChangesRequest& request)
+{
+    if (request.shard() < 0)
+        return InvalidArgument("shard cannot be negative");
+
+    // Offsets are transaction ids, cast to xid8 by the outbox query.
+    if (request.after_offset() < 0)
+        return InvalidArgument("after_offset cannot be negative");
+
+    return grpc::Status::OK;
+}
+#endif
+
+} // namespace library_service
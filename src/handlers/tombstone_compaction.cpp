@@ -0,0 +1,88 @@
+#include <handlers/tombstone_compaction.hpp>
+
+#include <stdexcept>
+
+#include <userver/engine/sleep.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/logging/log.hpp>
+
+namespace library_service {
+
+TombstoneCompactionConfig
+Parse(const userver::yaml_config::YamlConfig& value,
+      userver::formats::parse::To<TombstoneCompactionConfig>)
+{
+    TombstoneCompactionConfig config;
+    config.enabled = value["enabled"].As<bool>(config.enabled);
+    config.retention = std::chrono::hours(
+        value["retention-hours"].As<std::int64_t>(config.retention.count()));
+    config.period = std::chrono::milliseconds(
+        value["period-ms"].As<std::int64_t>(config.period.count()));
+    config.batch_size =
+        value["batch-size"].As<std::int32_t>(config.batch_size);
+    config.max_batches =
+        value["max-batches"].As<std::int32_t>(config.max_batches);
+    config.batch_pause = std::chrono::milliseconds(
+        value["batch-pause-ms"].As<std::int64_t>(config.batch_pause.count()));
+    config.outbox_retention =
+        std::chrono::hours(value["outbox-retention-hours"].As<std::int64_t>(
+            config.outbox_retention.count()));
+
+    if (config.batch_size <= 0 || config.max_batches <= 0)
+        throw std::runtime_error(
+            "tombstone-compaction batch-size and max-batches must be "
+            "positive");
+
+    return config;
+}
+
+TombstoneCompactor::TombstoneCompactor(
+    TombstoneCompactionConfig config, const pg::ILibraryRepository& repository)
+    : config_(config), repository_(repository)
+{}
+
+std::int64_t TombstoneCompactor::Run() const
+{
+    const auto tombstones =
+        DeleteInBatches("library tombstones", [this](std::int32_t limit) {
+            return repository_.DeleteTombstones(config_.retention, limit);
+        });
+    const auto changes =
+        DeleteInBatches("library change events", [this](std::int32_t limit) {
+            return repository_.DeleteLibraryChanges(config_.outbox_retention,
+                                                    limit);
+        });
+
+    return tombstones + changes;
+}
+
+template <typename DeleteBatch>
+std::int64_t TombstoneCompactor::DeleteInBatches(
+    std::string_view what, DeleteBatch delete_batch) const
+{
+    std::int64_t deleted = 0;
+    std::int32_t batches = 0;
+
+    while (batches < config_.max_batches)
+    {
+        if (batches > 0)
+            userver::engine::InterruptibleSleepFor(config_.batch_pause);
+        if (userver::engine::current_task::ShouldCancel())
+            break;
+
+        const auto rows = delete_batch(config_.batch_size);
+        deleted += rows;
+        ++batches;
+
+        if (rows < config_.batch_size)
+            break;
+    }
+
+    if (deleted > 0)
+        LOG_INFO() << "Deleted " << deleted << ' ' << what << " in "
+                   << batches << " batches";
+
+    return deleted;
+}
+
+} // namespace library_service
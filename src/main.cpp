@@ -16,9 +16,12 @@
 #include <userver/utils/daemon_run.hpp>
 
 #include <handlers/library_grpc.hpp>
+#include <tools/topology.hpp>
 
 int main(int argc, char* argv[])
 {
+    utils::ExportTopologyDefaults();
+
     auto component_list =
         userver::components::MinimalServerComponentList()
             .Append<userver::server::handlers::Ping>()
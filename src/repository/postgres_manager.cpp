@@ -1,65 +1,246 @@
 #include <repository/postgres_manager.hpp>
 
-#include <userver/storages/postgres/io/enum_types.hpp>
+#include <chrono>
+#include <sstream>
+
 #include <userver/storages/postgres/io/io_fwd.hpp>
-#include <userver/utils/trivial_map.hpp>
-
-#include <library/library_service.usrv.pb.hpp>
-
-template <>
-struct userver::storages::postgres::io::CppToUserPg<::library::GameStatus>
-{
-    static constexpr DBTypeName postgres_name = "playhub.game_status";
-    static constexpr USERVER_NAMESPACE::utils::TrivialBiMap enumerators =
-        [](auto selector) {
-            return selector()
-                .Case("unspecified",
-                      ::library::GameStatus::GAME_STATUS_UNSPECIFIED)
-                .Case("plan", ::library::GameStatus::GAME_STATUS_PLAN)
-                .Case("playing", ::library::GameStatus::GAME_STATUS_PLAYING)
-                .Case("dropped", ::library::GameStatus::GAME_STATUS_DROPPED)
-                .Case("completed", ::library::GameStatus::GAME_STATUS_COMPLETED)
-                .Case("waiting", ::library::GameStatus::GAME_STATUS_WAITING);
-        };
+#include <userver/storages/postgres/io/uuid.hpp>
+#include <userver/tracing/span.hpp>
+#include <userver/utils/async.hpp>
+
+#include <tools/slow_request_log.hpp>
+
+namespace pg {
+
+namespace {
+
+template <typename T>
+const T& Printable(const T& value)
+{
+    return value;
+}
+
+std::string_view Printable(entities::GameStatus status)
+{
+    return entities::ToDbName(status);
+}
+
+template <typename... Args>
+std::string FormatParams(const Args&... args)
+{
+    std::ostringstream params;
+    [[maybe_unused]] std::size_t index = 0;
+    ((params << (index++ ? ", $" : "$") << index << '=' << Printable(args)),
+     ...);
+    return params.str();
+}
+
+constexpr int kMaxUpsertAttempts = 3;
+
+} // namespace
+
+// An upsert is an update of an existing row, or failing that an insert
+// that does nothing on conflict; CreateLibraryEntry() retries until one of
+// them writes. A single INSERT ... ON CONFLICT DO UPDATE cannot tell a
+// concurrent first insert from its own: the previous status is read from
+// the statement snapshot, so both writers would count the entry as new.
+//
+// The change event and the analytics rollups are written by the same
+// statement, hence in the same transaction as the row. Shards are derived
+// from the canonical uuid text so every instance maps a user to the same
+// shard. Rollups only move when the status actually changes.
+//
+// The previous status is read by the UPDATE itself: its FROM subquery
+// locks the row, waiting for concurrent writers, and RETURNING hands the
+// old values to the rollup CTEs. A separate SELECT ... FOR UPDATE sibling
+// would run after the UPDATE and skip the row this statement had already
+// modified. Updating a removed entry revives its tombstone, which counts as
+// entering the status.
+const userver::storages::postgres::Query kUpdateLibraryEntry{
+    "WITH updated AS ("
+    "  UPDATE playhub.library AS l SET "
+    "    game_status = $3, "
+    "    created_at = NOW(), "
+    "    updated_at = NOW(), "
+    "    deleted_at = NULL "
+    "  FROM ("
+    "    SELECT game_status, deleted_at "
+    "    FROM playhub.library "
+    "    WHERE user_id = $1::uuid AND game_id = $2::uuid "
+    "    FOR UPDATE"
+    "  ) AS prev "
+    "  WHERE l.user_id = $1::uuid AND l.game_id = $2::uuid "
+    "  RETURNING "
+    "    l.user_id, l.game_id, l.game_status, l.created_at, l.updated_at, "
+    "    prev.game_status AS previous_status, "
+    "    prev.deleted_at IS NOT NULL AS was_removed"
+    "), change AS ("
+    "  INSERT INTO playhub.library_changes ("
+    "    shard, user_id, game_id, game_status, changed_at"
+    "  ) "
+    "  SELECT "
+    "    (hashtext(user_id::text) & 2147483647) % $4, "
+    "    user_id, game_id, game_status, updated_at "
+    "  FROM updated"
+    "), left_status AS ("
+    "  UPDATE playhub.library_status_counts AS counts "
+    "  SET entries = counts.entries - 1 "
+    "  FROM updated "
+    "  WHERE counts.user_id = updated.user_id "
+    "    AND counts.game_status = updated.previous_status "
+    "    AND NOT updated.was_removed "
+    "    AND updated.previous_status <> updated.game_status"
+    "), entered_status AS ("
+    "  INSERT INTO playhub.library_status_counts ("
+    "    user_id, game_status, entries"
+    "  ) "
+    "  SELECT user_id, game_status, 1 "
+    "  FROM updated "
+    "  WHERE was_removed OR previous_status <> game_status "
+    "  ON CONFLICT (user_id, game_status) DO UPDATE SET "
+    "    entries = library_status_counts.entries + 1"
+    "), activity AS ("
+    "  INSERT INTO playhub.library_daily_activity ("
+    "    user_id, day, game_status, transitions"
+    "  ) "
+    "  SELECT user_id, CURRENT_DATE, game_status, 1 "
+    "  FROM updated "
+    "  WHERE was_removed OR previous_status <> game_status "
+    "  ON CONFLICT (user_id, day, game_status) DO UPDATE SET "
+    "    transitions = library_daily_activity.transitions + 1"
+    ") "
+    "SELECT user_id, game_id, game_status, created_at, updated_at "
+    "FROM updated"
 };
 
-template <>
-struct userver::storages::postgres::io::CppToUserPg<entities::GameStatus>
-{
-    static constexpr DBTypeName postgres_name = "playhub.game_status";
-    static constexpr USERVER_NAMESPACE::utils::TrivialBiMap enumerators =
-        [](auto selector) {
-            return selector()
-                .Case("unspecified", entities::GameStatus::kUnspecified)
-                .Case("plan", entities::GameStatus::kPlan)
-                .Case("playing", entities::GameStatus::kPlaying)
-                .Case("dropped", entities::GameStatus::kDropped)
-                .Case("completed", entities::GameStatus::kCompleted)
-                .Case("waiting", entities::GameStatus::kWaiting);
-        };
+// Returns no row if the entry already exists, including one inserted by a
+// transaction that commits while this statement waits for it.
+const userver::storages::postgres::Query kInsertLibraryEntry{
+    "WITH inserted AS ("
+    "  INSERT INTO playhub.library ("
+    "    user_id, game_id, game_status"
+    "  ) "
+    "  VALUES ("
+    "    $1::uuid, $2::uuid, $3"
+    "  ) "
+    "  ON CONFLICT (user_id, game_id) DO NOTHING "
+    "  RETURNING "
+    "    user_id, game_id, game_status, created_at, updated_at"
+    "), change AS ("
+    "  INSERT INTO playhub.library_changes ("
+    "    shard, user_id, game_id, game_status, changed_at"
+    "  ) "
+    "  SELECT "
+    "    (hashtext(user_id::text) & 2147483647) % $4, "
+    "    user_id, game_id, game_status, updated_at "
+    "  FROM inserted"
+    "), entered_status AS ("
+    "  INSERT INTO playhub.library_status_counts ("
+    "    user_id, game_status, entries"
+    "  ) "
+    "  SELECT user_id, game_status, 1 "
+    "  FROM inserted "
+    "  ON CONFLICT (user_id, game_status) DO UPDATE SET "
+    "    entries = library_status_counts.entries + 1"
+    "), activity AS ("
+    "  INSERT INTO playhub.library_daily_activity ("
+    "    user_id, day, game_status, transitions"
+    "  ) "
+    "  SELECT user_id, CURRENT_DATE, game_status, 1 "
+    "  FROM inserted "
+    "  ON CONFLICT (user_id, day, game_status) DO UPDATE SET "
+    "    transitions = library_daily_activity.transitions + 1"
+    ") "
+    "SELECT user_id, game_id, game_status, created_at, updated_at "
+    "FROM inserted"
 };
 
-namespace pg {
+// Removal leaves a tombstone that reads skip until the compaction task
+// deletes it. The removed event and the rollup decrement are written by the
+// same statement. Entries that are already removed are left untouched.
+const userver::storages::postgres::Query kRemoveLibraryEntry{
+    "WITH removed AS ("
+    "  UPDATE playhub.library "
+    "  SET deleted_at = NOW() "
+    "  WHERE user_id = $1::uuid AND game_id = $2::uuid "
+    "    AND deleted_at IS NULL "
+    "  RETURNING user_id, game_id, game_status, deleted_at"
+    "), change AS ("
+    "  INSERT INTO playhub.library_changes ("
+    "    shard, user_id, game_id, game_status, removed, changed_at"
+    "  ) "
+    "  SELECT "
+    "    (hashtext(user_id::text) & 2147483647) % $3, "
+    "    user_id, game_id, game_status, TRUE, deleted_at "
+    "  FROM removed"
+    "), left_status AS ("
+    "  UPDATE playhub.library_status_counts AS counts "
+    "  SET entries = counts.entries - 1 "
+    "  FROM removed "
+    "  WHERE counts.user_id = removed.user_id "
+    "    AND counts.game_status = removed.game_status"
+    ") "
+    "SELECT COUNT(*) FROM removed"
+};
 
-const userver::storages::postgres::Query kUpsertLibraryEntry{
-    "INSERT INTO playhub.library ("
-    "  user_id, game_id, game_status"
+// One batch of a purge: tombstones up to $3 live entries of the user and
+// subtracts exactly those from their status counts. Rows locked by a
+// concurrent upsert are waited for rather than skipped, so that a purge run
+// until a partial batch leaves nothing behind.
+const userver::storages::postgres::Query kPurgeUserLibrary{
+    "WITH removed AS ("
+    "  UPDATE playhub.library "
+    "  SET deleted_at = NOW() "
+    "  WHERE (user_id, game_id) IN ("
+    "    SELECT user_id, game_id "
+    "    FROM playhub.library "
+    "    WHERE user_id = $1::uuid AND deleted_at IS NULL "
+    "    LIMIT $3 "
+    "    FOR UPDATE"
+    "  ) "
+    "  AND deleted_at IS NULL "
+    "  RETURNING user_id, game_id, game_status, deleted_at"
+    "), change AS ("
+    "  INSERT INTO playhub.library_changes ("
+    "    shard, user_id, game_id, game_status, removed, changed_at"
+    "  ) "
+    "  SELECT "
+    "    (hashtext(user_id::text) & 2147483647) % $2, "
+    "    user_id, game_id, game_status, TRUE, deleted_at "
+    "  FROM removed"
+    "), left_status AS ("
+    "  UPDATE playhub.library_status_counts AS counts "
+    "  SET entries = counts.entries - removed_counts.entries "
+    "  FROM ("
+    "    SELECT game_status, COUNT(*)::integer AS entries "
+    "    FROM removed "
+    "    GROUP BY game_status"
+    "  ) AS removed_counts "
+    "  WHERE counts.user_id = $1::uuid "
+    "    AND counts.game_status = removed_counts.game_status"
     ") "
-    "VALUES ("
-    "  $1::uuid, $2::uuid, $3::playhub.game_status"
+    "SELECT COUNT(*) FROM removed"
+};
+
+// Physically deletes tombstones older than the retention, at most $2 rows
+// at a time. Rows locked by a concurrent revive or another instance's
+// compaction are skipped rather than waited for.
+const userver::storages::postgres::Query kDeleteTombstones{
+    "DELETE FROM playhub.library "
+    "WHERE (user_id, game_id) IN ("
+    "  SELECT user_id, game_id "
+    "  FROM playhub.library "
+    "  WHERE deleted_at < NOW() - $1::bigint * INTERVAL '1 millisecond' "
+    "  LIMIT $2 "
+    "  FOR UPDATE SKIP LOCKED"
     ") "
-    "ON CONFLICT (user_id, game_id) DO UPDATE SET "
-    "  game_status = EXCLUDED.game_status, "
-    "  created_at = NOW(), "
-    "  updated_at = NOW() "
-    "RETURNING "
-    "  user_id, game_id, game_status, created_at, updated_at"
+    "AND deleted_at IS NOT NULL"
 };
 
 const userver::storages::postgres::Query kGetLibraryEntries{
     "SELECT user_id, game_id, game_status, created_at, updated_at "
     "FROM playhub.library "
-    "WHERE user_id = $1::uuid "
+    "WHERE user_id = $1::uuid AND deleted_at IS NULL "
     "ORDER BY updated_at DESC "
     "LIMIT $2 OFFSET $3"
 };
@@ -67,27 +248,169 @@ const userver::storages::postgres::Query kGetLibraryEntries{
 const userver::storages::postgres::Query kGetLibraryStats{
     "SELECT COUNT(*) "
     "FROM playhub.library "
-    "WHERE user_id = $1::uuid"
+    "WHERE user_id = $1::uuid AND deleted_at IS NULL"
+};
+
+const userver::storages::postgres::Query kGetLibraryEntry{
+    "SELECT user_id, game_id, game_status, created_at, updated_at "
+    "FROM playhub.library "
+    "WHERE user_id = $1::uuid AND game_id = $2::uuid "
+    "  AND deleted_at IS NULL"
+};
+
+const userver::storages::postgres::Query kGetLibraryGameIds{
+    "SELECT game_id "
+    "FROM playhub.library "
+    "WHERE user_id = $1::uuid AND deleted_at IS NULL"
+};
+
+// Events are ordered by the id of the transaction that wrote them, which is
+// also the offset handed to subscribers. Only transactions below the xmin of
+// the current snapshot are served: all of them have finished, and any event
+// written later gets a larger id, so a subscriber never skips one. The limit
+// counts transactions, so a batch never splits one.
+const userver::storages::postgres::Query kGetLibraryChanges{
+    "WITH batch AS ("
+    "  SELECT DISTINCT txid "
+    "  FROM playhub.library_changes "
+    "  WHERE shard = $1 AND txid > $2::text::xid8 "
+    "    AND txid < pg_snapshot_xmin(pg_current_snapshot()) "
+    "  ORDER BY txid "
+    "  LIMIT $3"
+    ") "
+    "SELECT txid::text::bigint, change_id, user_id, game_id, game_status, "
+    "  removed, changed_at "
+    "FROM playhub.library_changes "
+    "JOIN batch USING (txid) "
+    "WHERE shard = $1 "
+    "ORDER BY txid, change_id"
+};
+
+// Every shard, including transactions that have not finished yet; used by
+// the membership filters together with kGetOutboxXmin.
+const userver::storages::postgres::Query kGetLibraryChangesSince{
+    "SELECT txid::text::bigint, change_id, user_id, game_id, game_status, "
+    "  removed, changed_at "
+    "FROM playhub.library_changes "
+    "WHERE txid >= $1::text::xid8 AND change_id > $2 "
+    "ORDER BY change_id "
+    "LIMIT $3"
+};
+
+const userver::storages::postgres::Query kGetOutboxXmin{
+    "SELECT pg_snapshot_xmin(pg_current_snapshot())::text::bigint"
+};
+
+// Outbox retention, batched like kDeleteTombstones.
+const userver::storages::postgres::Query kDeleteLibraryChanges{
+    "DELETE FROM playhub.library_changes "
+    "WHERE change_id IN ("
+    "  SELECT change_id "
+    "  FROM playhub.library_changes "
+    "  WHERE changed_at < NOW() - $1::bigint * INTERVAL '1 millisecond' "
+    "  LIMIT $2 "
+    "  FOR UPDATE SKIP LOCKED"
+    ")"
+};
+
+const userver::storages::postgres::Query kGetStatusCounts{
+    "SELECT game_status, entries "
+    "FROM playhub.library_status_counts "
+    "WHERE user_id = $1::uuid AND entries > 0"
+};
+
+const userver::storages::postgres::Query kGetDailyActivity{
+    "SELECT day::timestamp, game_status, transitions "
+    "FROM playhub.library_daily_activity "
+    "WHERE user_id = $1::uuid AND day > CURRENT_DATE - $2::integer "
+    "ORDER BY day DESC, game_status"
 };
 
 PostgresManager::PostgresManager(
-    std::shared_ptr<userver::storages::postgres::Cluster> cluster)
-    : pg_cluster_(std::move(cluster))
+    std::shared_ptr<userver::storages::postgres::Cluster> cluster,
+    userver::engine::TaskProcessor* db_task_processor,
+    std::int32_t outbox_shards)
+    : pg_cluster_(std::move(cluster)), db_task_processor_(db_task_processor),
+      outbox_shards_(outbox_shards)
 {}
 
+template <typename Func>
+auto PostgresManager::RunOnDbTaskProcessor(Func&& func) const
+{
+    if (!db_task_processor_)
+        return func();
+
+    return userver::utils::Async(*db_task_processor_, "pg_query",
+                                 std::forward<Func>(func))
+        .Get();
+}
+
+template <typename Parse, typename... Args>
+auto PostgresManager::RunQuery(std::string_view span_name,
+                               const userver::storages::postgres::Query& query,
+                               Parse&& parse, const Args&... args) const
+{
+    userver::tracing::Span span{ std::string(span_name) };
+    const auto started = std::chrono::steady_clock::now();
+
+    std::size_t rows = 0;
+    auto result = RunOnDbTaskProcessor([&] {
+        const auto kResult = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster, query,
+            args...);
+        rows = kResult.Size();
+
+        return parse(kResult);
+    });
+
+    span.AddTag("rows", rows);
+    if (auto* record = utils::SlowRequestRecord::Current())
+    {
+        record->AddQuery(
+            query.Statement(), FormatParams(args...), rows,
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - started));
+    }
+
+    return result;
+}
+
 PostgresManager::LibraryPostgres
 PostgresManager::CreateLibraryEntry(std::string_view user_id,
                                     std::string_view game_id,
-                                    std::string_view game_status) const
+                                    entities::GameStatus game_status) const
 {
+    const auto parse =
+        [](const auto& result) -> std::optional<LibraryPostgres> {
+        if (result.IsEmpty())
+            return std::nullopt;
+
+        return result.template AsSingleRow<LibraryPostgres>(
+            userver::storages::postgres::kRowTag);
+    };
+
     try
     {
-        const auto kResult = pg_cluster_->Execute(
-            userver::storages::postgres::ClusterHostType::kMaster,
-            kUpsertLibraryEntry, user_id, game_id, game_status);
+        // Each miss means a concurrent insert or tombstone deletion won the
+        // race for the row; the next statement sees its outcome.
+        for (int attempt = 0; attempt < kMaxUpsertAttempts; ++attempt)
+        {
+            if (auto updated =
+                    RunQuery("pg_update_library_entry", kUpdateLibraryEntry,
+                             parse, user_id, game_id, game_status,
+                             outbox_shards_))
+                return *std::move(updated);
 
-        return kResult.AsSingleRow<LibraryPostgres>(
-            userver::storages::postgres::kRowTag);
+            if (auto inserted =
+                    RunQuery("pg_insert_library_entry", kInsertLibraryEntry,
+                             parse, user_id, game_id, game_status,
+                             outbox_shards_))
+                return *std::move(inserted);
+        }
+
+        LOG_ERROR() << "Upsert of game " << game_id << " for user "
+                    << user_id << " lost " << kMaxUpsertAttempts
+                    << " races in a row";
     }
     catch (const std::exception& e)
     {
@@ -103,12 +426,13 @@ PostgresManager::GetLibraryEntries(std::string_view user_id, std::int32_t limit,
 {
     try
     {
-        const auto kResult = pg_cluster_->Execute(
-            userver::storages::postgres::ClusterHostType::kMaster,
-            kGetLibraryEntries, user_id, limit, offset);
-
-        return kResult.AsContainer<LibrariesPostgres>(
-            userver::storages::postgres::kRowTag);
+        return RunQuery(
+            "pg_get_library_entries", kGetLibraryEntries,
+            [](const auto& result) {
+                return result.template AsContainer<LibrariesPostgres>(
+                    userver::storages::postgres::kRowTag);
+            },
+            user_id, limit, offset);
     }
     catch (const std::exception& e)
     {
@@ -122,11 +446,12 @@ std::int32_t PostgresManager::GetLibraryStats(std::string_view user_id) const
 {
     try
     {
-        const auto result = pg_cluster_->Execute(
-            userver::storages::postgres::ClusterHostType::kMaster,
-            kGetLibraryStats, user_id);
-
-        return result.AsSingleRow<std::int64_t>();
+        return RunQuery(
+            "pg_get_library_stats", kGetLibraryStats,
+            [](const auto& result) -> std::int32_t {
+                return result.template AsSingleRow<std::int64_t>();
+            },
+            user_id);
     }
     catch (const std::exception& e)
     {
@@ -136,4 +461,139 @@ std::int32_t PostgresManager::GetLibraryStats(std::string_view user_id) const
     return 0;
 }
 
-} // namespace pg
\ No newline at end of file
+std::optional<PostgresManager::LibraryPostgres>
+PostgresManager::GetLibraryEntry(std::string_view user_id,
+                                 std::string_view game_id) const
+{
+    return RunQuery(
+        "pg_get_library_entry", kGetLibraryEntry,
+        [](const auto& result) -> std::optional<LibraryPostgres> {
+            if (result.IsEmpty())
+                return std::nullopt;
+
+            return result.template AsSingleRow<LibraryPostgres>(
+                userver::storages::postgres::kRowTag);
+        },
+        user_id, game_id);
+}
+
+std::vector<boost::uuids::uuid>
+PostgresManager::GetLibraryGameIds(std::string_view user_id) const
+{
+    return RunQuery(
+        "pg_get_library_game_ids", kGetLibraryGameIds,
+        [](const auto& result) {
+            return result
+                .template AsContainer<std::vector<boost::uuids::uuid>>();
+        },
+        user_id);
+}
+
+bool PostgresManager::RemoveLibraryEntry(std::string_view user_id,
+                                         std::string_view game_id) const
+{
+    return RunQuery(
+        "pg_remove_library_entry", kRemoveLibraryEntry,
+        [](const auto& result) {
+            return result.template AsSingleRow<std::int64_t>() > 0;
+        },
+        user_id, game_id, outbox_shards_);
+}
+
+std::int32_t PostgresManager::PurgeUserLibrary(std::string_view user_id,
+                                               std::int32_t limit) const
+{
+    return RunQuery(
+        "pg_purge_user_library", kPurgeUserLibrary,
+        [](const auto& result) -> std::int32_t {
+            return result.template AsSingleRow<std::int64_t>();
+        },
+        user_id, outbox_shards_, limit);
+}
+
+std::int32_t
+PostgresManager::DeleteTombstones(std::chrono::milliseconds retention,
+                                  std::int32_t limit) const
+{
+    return RunQuery(
+        "pg_delete_tombstones", kDeleteTombstones,
+        [](const auto& result) -> std::int32_t {
+            return result.RowsAffected();
+        },
+        static_cast<std::int64_t>(retention.count()), limit);
+}
+
+PostgresManager::LibraryChangesPostgres
+PostgresManager::GetLibraryChanges(std::int32_t shard, std::int64_t after,
+                                   std::int32_t limit) const
+{
+    return RunQuery(
+        "pg_get_library_changes", kGetLibraryChanges,
+        [](const auto& result) {
+            return result.template AsContainer<LibraryChangesPostgres>(
+                userver::storages::postgres::kRowTag);
+        },
+        shard, after, limit);
+}
+
+PostgresManager::LibraryChangesPostgres
+PostgresManager::GetLibraryChangesSince(std::int64_t min_txid,
+                                        std::int64_t after,
+                                        std::int32_t limit) const
+{
+    return RunQuery(
+        "pg_get_library_changes_since", kGetLibraryChangesSince,
+        [](const auto& result) {
+            return result.template AsContainer<LibraryChangesPostgres>(
+                userver::storages::postgres::kRowTag);
+        },
+        min_txid, after, limit);
+}
+
+std::int64_t PostgresManager::GetOutboxXmin() const
+{
+    return RunQuery(
+        "pg_get_outbox_xmin", kGetOutboxXmin,
+        [](const auto& result) {
+            return result.template AsSingleRow<std::int64_t>();
+        });
+}
+
+std::int32_t
+PostgresManager::DeleteLibraryChanges(std::chrono::milliseconds retention,
+                                      std::int32_t limit) const
+{
+    return RunQuery(
+        "pg_delete_library_changes", kDeleteLibraryChanges,
+        [](const auto& result) -> std::int32_t {
+            return result.RowsAffected();
+        },
+        static_cast<std::int64_t>(retention.count()), limit);
+}
+
+PostgresManager::StatusCountsPostgres
+PostgresManager::GetStatusCounts(std::string_view user_id) const
+{
+    return RunQuery(
+        "pg_get_status_counts", kGetStatusCounts,
+        [](const auto& result) {
+            return result.template AsContainer<StatusCountsPostgres>(
+                userver::storages::postgres::kRowTag);
+        },
+        user_id);
+}
+
+PostgresManager::DailyActivitiesPostgres
+PostgresManager::GetDailyActivity(std::string_view user_id,
+                                  std::int32_t days) const
+{
+    return RunQuery(
+        "pg_get_daily_activity", kGetDailyActivity,
+        [](const auto& result) {
+            return result.template AsContainer<DailyActivitiesPostgres>(
+                userver::storages::postgres::kRowTag);
+        },
+        user_id, days);
+}
+
+} // namespace pg
@@ -0,0 +1,91 @@
+#include <tools/bloom_filter.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t kWordBits = 64;
+
+std::uint64_t Mix(std::uint64_t value)
+{
+    // splitmix64 finalizer: ids from tests and load generators are far from
+    // random, so the halves are mixed before use.
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+struct Hashes
+{
+    std::uint64_t first;
+    std::uint64_t second;
+};
+
+Hashes HashUuid(const boost::uuids::uuid& key)
+{
+    std::uint64_t high = 0;
+    std::uint64_t low = 0;
+    std::memcpy(&high, key.data, sizeof(high));
+    std::memcpy(&low, key.data + sizeof(high), sizeof(low));
+
+    // Odd second hash keeps the probe sequence from cycling early.
+    return { Mix(high ^ Mix(low)), Mix(low + 0x9e3779b97f4a7c15ULL) | 1 };
+}
+
+} // namespace
+
+utils::BloomFilter::BloomFilter(std::size_t capacity,
+                                double false_positive_rate)
+    : capacity_(std::max<std::size_t>(capacity, 1))
+{
+    const double rate = std::clamp(false_positive_rate, 1e-6, 0.5);
+    const double ln2 = std::log(2.0);
+
+    const auto bits = static_cast<std::size_t>(std::ceil(
+        -static_cast<double>(capacity_) * std::log(rate) / (ln2 * ln2)));
+    words_.resize((std::max<std::size_t>(bits, kWordBits) + kWordBits - 1) /
+                  kWordBits);
+    bit_count_ = words_.size() * kWordBits;
+
+    hash_count_ = std::clamp<std::size_t>(
+        static_cast<std::size_t>(std::round(
+            static_cast<double>(bit_count_) / capacity_ * ln2)),
+        1, 16);
+}
+
+void utils::BloomFilter::Add(const boost::uuids::uuid& key)
+{
+    const auto hashes = HashUuid(key);
+    bool added = false;
+    for (std::size_t i = 0; i < hash_count_; ++i)
+    {
+        const auto bit = (hashes.first + i * hashes.second) % bit_count_;
+        const auto mask = std::uint64_t{ 1 } << (bit % kWordBits);
+        added |= !(words_[bit / kWordBits] & mask);
+        words_[bit / kWordBits] |= mask;
+    }
+
+    // Keys that set no new bit are already (or falsely) contained, they do
+    // not fill the filter further.
+    if (added)
+        ++size_;
+}
+
+bool utils::BloomFilter::MayContain(const boost::uuids::uuid& key) const
+{
+    const auto hashes = HashUuid(key);
+    for (std::size_t i = 0; i < hash_count_; ++i)
+    {
+        const auto bit = (hashes.first + i * hashes.second) % bit_count_;
+        const auto mask = std::uint64_t{ 1 } << (bit % kWordBits);
+        if (!(words_[bit / kWordBits] & mask))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,160 @@
+#include <tools/slow_request_log.hpp>
+
+#include <sstream>
+
+#include <userver/engine/task/local_variable.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/utils/rand.hpp>
+
+namespace {
+
+constexpr std::uint32_t kSampleScale = 1'000'000;
+
+userver::engine::TaskLocalVariable<utils::SlowRequestRecord*> current_record;
+
+double ToMilliseconds(std::chrono::microseconds duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+utils::SlowRequestConfig
+utils::Parse(const userver::yaml_config::YamlConfig& value,
+             userver::formats::parse::To<SlowRequestConfig>)
+{
+    SlowRequestConfig config;
+    config.enabled = value["enabled"].As<bool>(config.enabled);
+    config.threshold = std::chrono::milliseconds(
+        value["threshold-ms"].As<std::int64_t>(config.threshold.count()));
+    config.sample_rate = value["sample-rate"].As<double>(config.sample_rate);
+
+    return config;
+}
+
+utils::SlowRequestRecord::Stage::Stage(SlowRequestRecord* record,
+                                       std::string_view name)
+    : record_(record), name_(name)
+{
+    if (record_)
+        started_ = std::chrono::steady_clock::now();
+}
+
+utils::SlowRequestRecord::Stage::~Stage()
+{
+    if (!record_ || record_->stage_count_ == kMaxStages)
+        return;
+
+    record_->stages_[record_->stage_count_++] = {
+        name_, std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - started_)
+    };
+}
+
+utils::SlowRequestRecord::SlowRequestRecord(const SlowRequestConfig& config,
+                                            std::string_view rpc_name)
+    : rpc_name_(rpc_name), threshold_(config.threshold),
+      enabled_(config.enabled),
+      sampled_(enabled_ && userver::utils::RandRange(kSampleScale) <
+                               config.sample_rate * kSampleScale)
+{
+    if (!enabled_)
+        return;
+
+    started_ = std::chrono::steady_clock::now();
+    if (!sampled_)
+        return;
+
+    previous_ = *current_record;
+    *current_record = this;
+}
+
+utils::SlowRequestRecord::~SlowRequestRecord()
+{
+    if (!enabled_)
+        return;
+
+    if (sampled_)
+        *current_record = previous_;
+
+    try
+    {
+        Flush();
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR() << "Failed to write slow request log: " << e.what();
+    }
+}
+
+utils::SlowRequestRecord::Stage
+utils::SlowRequestRecord::StartStage(std::string_view name)
+{
+    return Stage(enabled_ ? this : nullptr, name);
+}
+
+void utils::SlowRequestRecord::AddQuery(std::string_view statement,
+                                        std::string params, std::size_t rows,
+                                        std::chrono::microseconds duration)
+{
+    queries_.push_back(
+        { std::string(statement), std::move(params), rows, duration });
+}
+
+std::chrono::microseconds utils::SlowRequestRecord::Elapsed() const
+{
+    if (!enabled_)
+        return std::chrono::microseconds::zero();
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started_);
+}
+
+utils::SlowRequestRecord* utils::SlowRequestRecord::Current()
+{
+    return *current_record;
+}
+
+void utils::SlowRequestRecord::Flush() const
+{
+    const auto total = Elapsed();
+
+    if (total >= threshold_)
+    {
+        LOG_WARNING() << "Slow request " << rpc_name_ << Details(total);
+    }
+    else if (sampled_)
+    {
+        // Details are only built when debug logging is on.
+        LOG_DEBUG() << "Sampled request " << rpc_name_ << Details(total);
+    }
+}
+
+userver::logging::LogExtra
+utils::SlowRequestRecord::Details(std::chrono::microseconds total) const
+{
+    std::ostringstream stages;
+    for (std::size_t i = 0; i < stage_count_; ++i)
+    {
+        stages << stages_[i].name << '='
+               << ToMilliseconds(stages_[i].duration) << "ms ";
+    }
+
+    std::ostringstream queries;
+    for (const auto& query : queries_)
+    {
+        queries << '[' << ToMilliseconds(query.duration) << "ms, "
+                << query.rows << " rows] " << query.statement << " ("
+                << query.params << "); ";
+    }
+
+    userver::logging::LogExtra extra;
+    extra.Extend("rpc", std::string(rpc_name_));
+    extra.Extend("total_ms", ToMilliseconds(total));
+    extra.Extend("stages", stages.str());
+    extra.Extend("sampled", sampled_);
+    if (sampled_)
+        extra.Extend("queries", queries.str());
+
+    return extra;
+}
@@ -0,0 +1,129 @@
+#include <tools/topology.hpp>
+
+#include <sched.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+constexpr const char* kCompletionQueuesEnv = "LIBRARY_GRPC_COMPLETION_QUEUES";
+constexpr const char* kGrpcWorkersEnv = "LIBRARY_GRPC_WORKER_THREADS";
+constexpr const char* kMainWorkersEnv = "LIBRARY_MAIN_WORKER_THREADS";
+
+constexpr const char* kCgroupV2CpuMax = "/sys/fs/cgroup/cpu.max";
+constexpr const char* kCgroupV1Quota = "/sys/fs/cgroup/cpu/cpu.cfs_quota_us";
+constexpr const char* kCgroupV1Period = "/sys/fs/cgroup/cpu/cpu.cfs_period_us";
+
+void SetEnvDefault(const char* name, std::size_t value)
+{
+    ::setenv(name, std::to_string(value).c_str(), /*overwrite=*/0);
+}
+
+std::optional<std::string> ReadFile(const char* path)
+{
+    std::ifstream file(path);
+    if (!file)
+        return std::nullopt;
+
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+std::size_t AffinityCores()
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) == 0)
+        return CPU_COUNT(&set);
+
+    return std::thread::hardware_concurrency();
+}
+
+std::optional<std::size_t> CgroupQuotaCores()
+{
+    if (const auto cpu_max = ReadFile(kCgroupV2CpuMax))
+        return utils::ParseCgroupCpuMax(*cpu_max);
+
+    const auto quota = ReadFile(kCgroupV1Quota);
+    const auto period = ReadFile(kCgroupV1Period);
+    if (!quota || !period)
+        return std::nullopt;
+
+    return utils::CpuQuotaCores(std::atoll(quota->c_str()),
+                                std::atoll(period->c_str()));
+}
+
+} // namespace
+
+utils::ServiceTopology utils::ComputeTopology(std::size_t cores)
+{
+    cores = std::max<std::size_t>(cores, 1);
+
+    // Completion queue threads only shuttle events into coroutines, one per
+    // four cores is enough to keep them off the critical path. The main
+    // task processor only serves the monitoring listener and periodic
+    // components and gets one thread. The rest of the cores go to the
+    // handlers, so the three add up to the cores available from three cores
+    // up; below that each still needs one thread.
+    ServiceTopology topology{};
+    topology.grpc_completion_queues = std::clamp<std::size_t>(cores / 4, 1, 16);
+    topology.main_worker_threads = 1;
+
+    const auto reserved =
+        topology.grpc_completion_queues + topology.main_worker_threads;
+    topology.grpc_worker_threads =
+        cores > reserved ? cores - reserved : std::size_t{ 1 };
+
+    return topology;
+}
+
+std::optional<std::size_t> utils::CpuQuotaCores(std::int64_t quota_us,
+                                                std::int64_t period_us)
+{
+    if (quota_us <= 0 || period_us <= 0)
+        return std::nullopt;
+
+    return std::max<std::size_t>(quota_us / period_us, 1);
+}
+
+std::optional<std::size_t> utils::ParseCgroupCpuMax(std::string_view content)
+{
+    std::istringstream stream{ std::string(content) };
+    std::string quota;
+    std::int64_t period = 0;
+    if (!(stream >> quota >> period) || quota == "max")
+        return std::nullopt;
+
+    char* end = nullptr;
+    const auto quota_us = std::strtoll(quota.c_str(), &end, 10);
+    if (end != quota.c_str() + quota.size())
+        return std::nullopt;
+
+    return CpuQuotaCores(quota_us, period);
+}
+
+std::size_t utils::CapByCpuQuota(std::size_t cores,
+                                 std::optional<std::size_t> quota_cores)
+{
+    return quota_cores ? std::min(cores, *quota_cores) : cores;
+}
+
+std::size_t utils::DetectAvailableCores()
+{
+    return CapByCpuQuota(AffinityCores(), CgroupQuotaCores());
+}
+
+void utils::ExportTopologyDefaults()
+{
+    const auto topology = ComputeTopology(DetectAvailableCores());
+
+    SetEnvDefault(kCompletionQueuesEnv, topology.grpc_completion_queues);
+    SetEnvDefault(kGrpcWorkersEnv, topology.grpc_worker_threads);
+    SetEnvDefault(kMainWorkersEnv, topology.main_worker_threads);
+}
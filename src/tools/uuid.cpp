@@ -0,0 +1,77 @@
+#include <tools/uuid.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace utils {
+
+namespace {
+
+constexpr std::size_t kUuidLength = 36;
+constexpr std::int8_t kNotHex = -1;
+
+constexpr std::array<std::int8_t, 256> MakeHexTable()
+{
+    std::array<std::int8_t, 256> table{};
+    for (auto& value : table)
+        value = kNotHex;
+
+    for (int i = 0; i < 10; ++i)
+        table['0' + i] = static_cast<std::int8_t>(i);
+    for (int i = 0; i < 6; ++i)
+    {
+        table['a' + i] = static_cast<std::int8_t>(10 + i);
+        table['A' + i] = static_cast<std::int8_t>(10 + i);
+    }
+
+    return table;
+}
+
+constexpr auto kHexTable = MakeHexTable();
+
+constexpr bool IsDashPosition(std::size_t i)
+{
+    return i == 8 || i == 13 || i == 18 || i == 23;
+}
+
+std::int8_t HexValue(char c)
+{
+    return kHexTable[static_cast<unsigned char>(c)];
+}
+
+} // namespace
+
+bool IsValidUuid(std::string_view value) noexcept
+{
+    if (value.size() != kUuidLength)
+        return false;
+
+    for (std::size_t i = 0; i < kUuidLength; ++i)
+    {
+        if (IsDashPosition(i) ? value[i] != '-' : HexValue(value[i]) == kNotHex)
+            return false;
+    }
+
+    return true;
+}
+
+std::optional<boost::uuids::uuid> ParseUuid(std::string_view value) noexcept
+{
+    if (!IsValidUuid(value))
+        return std::nullopt;
+
+    boost::uuids::uuid uuid{};
+    std::size_t byte = 0;
+    for (std::size_t i = 0; i < kUuidLength; i += 2)
+    {
+        if (IsDashPosition(i))
+            ++i;
+
+        uuid.data[byte++] = static_cast<std::uint8_t>(
+            HexValue(value[i]) << 4 | HexValue(value[i + 1]));
+    }
+
+    return uuid;
+}
+
+} // namespace utils
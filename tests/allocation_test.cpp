@@ -0,0 +1,331 @@
+// Allocation properties of the request hot path. Built as its own
+// executable because it replaces the global allocation functions, which
+// must not leak into the other tests.
+
+#include <gtest/gtest.h>
+
+#include <handlers/request_validation.hpp>
+#include <structs/game_status.hpp>
+#include <tools/utils.hpp>
+#include <tools/uuid.hpp>
+
+#include <boost/uuid/uuid_io.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+
+#include "uuid_generators.hpp"
+
+// Sanitizers own the global allocation functions; the tests are skipped
+// under them.
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define LIBRARY_NO_ALLOCATION_COUNTING
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || \
+    __has_feature(memory_sanitizer)
+#define LIBRARY_NO_ALLOCATION_COUNTING
+#endif
+#endif
+
+namespace {
+
+thread_local std::size_t allocation_count = 0;
+thread_local std::size_t allocated_bytes = 0;
+
+} // namespace
+
+#ifndef LIBRARY_NO_ALLOCATION_COUNTING
+namespace {
+
+void* CountedAlloc(std::size_t size) noexcept
+{
+    ++allocation_count;
+    allocated_bytes += size;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* CountedAlignedAlloc(std::size_t size, std::align_val_t align) noexcept
+{
+    ++allocation_count;
+    allocated_bytes += size;
+
+    // aligned_alloc wants a size that is a multiple of the alignment.
+    const auto alignment = static_cast<std::size_t>(align);
+    const auto rounded = (std::max<std::size_t>(size, 1) + alignment - 1) /
+                         alignment * alignment;
+    return std::aligned_alloc(alignment, rounded);
+}
+
+} // namespace
+
+// Every replaceable form is replaced, so that no allocation bypasses the
+// counters and no pointer is freed by a different allocator than the one
+// that returned it.
+void* operator new(std::size_t size)
+{
+    if (void* ptr = CountedAlloc(size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    if (void* ptr = CountedAlignedAlloc(size, align))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+    return ::operator new(size, align);
+}
+
+void* operator new(std::size_t size, std::align_val_t align,
+                   const std::nothrow_t&) noexcept
+{
+    return CountedAlignedAlloc(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align,
+                     const std::nothrow_t&) noexcept
+{
+    return CountedAlignedAlloc(size, align);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t,
+                     const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t,
+                       const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+namespace {
+
+using library_service::test::NearUuid;
+using library_service::test::RandomUuid;
+
+constexpr int kIterations = 10000;
+
+class AllocationScope
+{
+public:
+    std::size_t Count() const { return allocation_count - count_; }
+    std::size_t Bytes() const { return allocated_bytes - bytes_; }
+
+private:
+    std::size_t count_ = allocation_count;
+    std::size_t bytes_ = allocated_bytes;
+};
+
+#ifdef LIBRARY_NO_ALLOCATION_COUNTING
+#define SKIP_WITHOUT_ALLOCATION_COUNTING() \
+    GTEST_SKIP() << "operator new is owned by the sanitizer"
+#else
+#define SKIP_WITHOUT_ALLOCATION_COUNTING() (void)0
+#endif
+
+TEST(AllocationCountingTest, CountsEveryAllocationForm)
+{
+    SKIP_WITHOUT_ALLOCATION_COUNTING();
+
+    struct alignas(64) Aligned
+    {
+        char data[64];
+    };
+
+    const AllocationScope scope;
+    delete new int(1);
+    delete[] new int[4];
+    delete new (std::nothrow) int(1);
+    delete[] new (std::nothrow) int[4];
+    delete new Aligned;
+    delete[] new Aligned[2];
+    EXPECT_EQ(scope.Count(), 6u);
+}
+
+TEST(AllocationPropertyTest, UuidValidationNeverAllocates)
+{
+    SKIP_WITHOUT_ALLOCATION_COUNTING();
+
+    std::mt19937_64 rng(99);
+    const std::string huge(1 << 20, 'a');
+
+    for (int i = 0; i < kIterations; ++i)
+    {
+        const auto value = NearUuid(rng);
+
+        const AllocationScope scope;
+        [[maybe_unused]] const auto valid = utils::IsValidUuid(value);
+        [[maybe_unused]] const auto parsed = utils::ParseUuid(value);
+        [[maybe_unused]] const auto rejected = utils::IsValidUuid(huge);
+        ASSERT_EQ(scope.Count(), 0u) << value;
+    }
+}
+
+TEST(AllocationPropertyTest, StatusMappingNeverAllocates)
+{
+    SKIP_WITHOUT_ALLOCATION_COUNTING();
+
+    std::mt19937_64 rng(5);
+
+    for (int i = 0; i < kIterations; ++i)
+    {
+        // Mostly out-of-range wire values, proto3 lets them through.
+        const auto proto = static_cast<::library::GameStatus>(
+            std::uniform_int_distribution<int>(-8, 64)(rng));
+
+        const AllocationScope scope;
+        const auto entity = entities::FromProto(proto);
+        [[maybe_unused]] const auto back = entities::ToProto(entity);
+        [[maybe_unused]] const auto db_name = entities::ToDbName(entity);
+        [[maybe_unused]] const auto name = utils::GameStatusToString(proto);
+        ASSERT_EQ(scope.Count(), 0u) << proto;
+    }
+}
+
+TEST(AllocationPropertyTest, TimePointConversionNeverAllocates)
+{
+    SKIP_WITHOUT_ALLOCATION_COUNTING();
+
+    std::mt19937_64 rng(11);
+
+    for (int i = 0; i < kIterations; ++i)
+    {
+        const userver::storages::postgres::TimePointWithoutTz time_point{
+            std::chrono::system_clock::time_point{
+                std::chrono::seconds(
+                    std::uniform_int_distribution<std::int64_t>(
+                        -2'000'000'000, 4'000'000'000)(rng)) }
+        };
+
+        const AllocationScope scope;
+        [[maybe_unused]] const auto timestamp =
+            utils::TimePointToProtobuf(time_point);
+        ASSERT_EQ(scope.Count(), 0u);
+    }
+}
+
+TEST(AllocationPropertyTest, ValidRequestsAreCheckedWithoutAllocating)
+{
+    SKIP_WITHOUT_ALLOCATION_COUNTING();
+
+    std::mt19937_64 rng(3);
+
+    for (int i = 0; i < kIterations; ++i)
+    {
+        ::library::UpdateLibraryEntryRequest update;
+        update.set_user_id(boost::uuids::to_string(RandomUuid(rng)));
+        update.set_game_id(boost::uuids::to_string(RandomUuid(rng)));
+        const auto& mapping =
+            entities::kGameStatusMappings[rng() % entities::kGameStatusCount];
+        update.set_status(mapping.proto);
+
+        ::library::GetUserLibraryRequest get;
+        get.set_user_id(update.user_id());
+        get.set_limit(static_cast<std::int32_t>(rng() % 1000));
+        get.set_offset(static_cast<std::int32_t>(rng() % 1000));
+
+        const AllocationScope scope;
+        ASSERT_TRUE(library_service::Validate(update).ok());
+        ASSERT_TRUE(library_service::Validate(get).ok());
+        ASSERT_EQ(scope.Count(), 0u);
+    }
+}
+
+// Rejecting an oversized id must not copy it.
+TEST(AllocationPropertyTest, RejectionDoesNotCopyInput)
+{
+    SKIP_WITHOUT_ALLOCATION_COUNTING();
+
+    ::library::GetUserLibraryRequest request;
+    request.set_user_id(std::string(1 << 20, 'z'));
+
+    const AllocationScope scope;
+    for (int i = 0; i < kIterations; ++i)
+    {
+        const auto status = library_service::Validate(request);
+        ASSERT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+    }
+
+    EXPECT_LT(scope.Bytes(), kIterations * std::size_t{ 1024 });
+}
+
+} // namespace
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <tools/bloom_filter.hpp>
+
+#include <boost/uuid/random_generator.hpp>
+
+#include <vector>
+
+namespace {
+
+TEST(BloomFilterTest, HasNoFalseNegatives)
+{
+    utils::BloomFilter filter(1000, 0.01);
+    boost::uuids::random_generator generator;
+
+    std::vector<boost::uuids::uuid> keys;
+    for (int i = 0; i < 1000; ++i)
+    {
+        keys.push_back(generator());
+        filter.Add(keys.back());
+    }
+
+    for (const auto& key : keys)
+        EXPECT_TRUE(filter.MayContain(key));
+
+    // Keys that were false positives when added are not counted.
+    EXPECT_LE(filter.Size(), 1000u);
+    EXPECT_GE(filter.Size(), 980u);
+}
+
+TEST(BloomFilterTest, AddingAKeyAgainDoesNotGrowSize)
+{
+    utils::BloomFilter filter(16, 0.01);
+    boost::uuids::random_generator generator;
+    const auto key = generator();
+
+    for (int i = 0; i < 100; ++i)
+        filter.Add(key);
+
+    EXPECT_EQ(filter.Size(), 1u);
+    EXPECT_LT(filter.Size(), filter.Capacity());
+}
+
+TEST(BloomFilterTest, KeepsFalsePositiveRateNearTarget)
+{
+    utils::BloomFilter filter(1000, 0.01);
+    boost::uuids::random_generator generator;
+
+    for (int i = 0; i < 1000; ++i)
+        filter.Add(generator());
+
+    int false_positives = 0;
+    constexpr int kProbes = 100000;
+    for (int i = 0; i < kProbes; ++i)
+        false_positives += filter.MayContain(generator());
+
+    EXPECT_LT(false_positives, kProbes * 0.02);
+}
+
+TEST(BloomFilterTest, EmptyFilterContainsNothing)
+{
+    utils::BloomFilter filter(0, 0.01);
+    boost::uuids::random_generator generator;
+
+    for (int i = 0; i < 100; ++i)
+        EXPECT_FALSE(filter.MayContain(generator()));
+
+    EXPECT_GE(filter.Capacity(), 1u);
+}
+
+} // namespace
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <handlers/compression_policy.hpp>
+
+namespace {
+
+using library_service::CompressionConfig;
+using library_service::CompressionDecision;
+using library_service::CompressionMetrics;
+using library_service::CompressionPolicy;
+
+CompressionConfig EnabledConfig()
+{
+    CompressionConfig config;
+    config.enabled = true;
+    config.algorithm = GRPC_COMPRESS_GZIP;
+    config.min_size_bytes = 1024;
+    return config;
+}
+
+TEST(CompressionPolicyTest, DefaultPolicyIsDisabled)
+{
+    CompressionPolicy policy;
+
+    EXPECT_EQ(policy.Decide(1 << 20), CompressionDecision::kDisabled);
+}
+
+TEST(CompressionPolicyTest, SkipsMessagesBelowThreshold)
+{
+    CompressionMetrics metrics;
+    CompressionPolicy policy(EnabledConfig(), metrics);
+
+    EXPECT_EQ(policy.Decide(1023), CompressionDecision::kSkipSmall);
+    EXPECT_EQ(policy.Decide(1024), CompressionDecision::kCompress);
+}
+
+TEST(CompressionPolicyTest, DisabledConfigNeverCompresses)
+{
+    auto config = EnabledConfig();
+    config.enabled = false;
+
+    CompressionMetrics metrics;
+    CompressionPolicy policy(config, metrics);
+
+    EXPECT_EQ(policy.Decide(1 << 20), CompressionDecision::kDisabled);
+}
+
+} // namespace
@@ -9,6 +9,7 @@
 #include <library/library_service.usrv.pb.hpp>
 
 #include <handlers/library_grpc.hpp>
+#include <handlers/tombstone_compaction.hpp>
 #include <repository/postgres_manager.hpp>
 #include <structs/library_postgres.hpp>
 #include <tools/utils.hpp>
@@ -27,7 +28,7 @@ class MockLibraryRepository : public pg::ILibraryRepository
 public:
     MOCK_METHOD(entities::LibraryPostgres, CreateLibraryEntry,
                 (std::string_view user_id, std::string_view game_id,
-                 std::string_view status),
+                 entities::GameStatus status),
                 (const, override));
 
     MOCK_METHOD(std::vector<entities::LibraryPostgres>, GetLibraryEntries,
@@ -37,6 +38,50 @@ public:
 
     MOCK_METHOD(std::int32_t, GetLibraryStats, (std::string_view user_id),
                 (const, override));
+
+    MOCK_METHOD(std::optional<entities::LibraryPostgres>, GetLibraryEntry,
+                (std::string_view user_id, std::string_view game_id),
+                (const, override));
+
+    MOCK_METHOD(std::vector<boost::uuids::uuid>, GetLibraryGameIds,
+                (std::string_view user_id), (const, override));
+
+    MOCK_METHOD(bool, RemoveLibraryEntry,
+                (std::string_view user_id, std::string_view game_id),
+                (const, override));
+
+    MOCK_METHOD(std::int32_t, PurgeUserLibrary,
+                (std::string_view user_id, std::int32_t limit),
+                (const, override));
+
+    MOCK_METHOD(std::int32_t, DeleteTombstones,
+                (std::chrono::milliseconds retention, std::int32_t limit),
+                (const, override));
+
+    MOCK_METHOD(std::vector<entities::LibraryChangePostgres>,
+                GetLibraryChanges,
+                (std::int32_t shard, std::int64_t after, std::int32_t limit),
+                (const, override));
+
+    MOCK_METHOD(std::vector<entities::LibraryChangePostgres>,
+                GetLibraryChangesSince,
+                (std::int64_t min_txid, std::int64_t after,
+                 std::int32_t limit),
+                (const, override));
+
+    MOCK_METHOD(std::int64_t, GetOutboxXmin, (), (const, override));
+
+    MOCK_METHOD(std::int32_t, DeleteLibraryChanges,
+                (std::chrono::milliseconds retention, std::int32_t limit),
+                (const, override));
+
+    MOCK_METHOD(std::vector<entities::StatusCountPostgres>, GetStatusCounts,
+                (std::string_view user_id), (const, override));
+
+    MOCK_METHOD(std::vector<entities::DailyActivityPostgres>,
+                GetDailyActivity,
+                (std::string_view user_id, std::int32_t days),
+                (const, override));
 };
 
 entities::LibraryPostgres CreateFakeLibraryEntry(std::string_view user_id_str)
@@ -61,8 +106,7 @@ entities::LibraryPostgres CreateFakeLibraryEntry(std::string_view user_id_str)
     }
 
     entry.game_id = boost::uuids::random_generator()();
-    entry.game_status = static_cast<entities::GameStatus>(
-        ::library::GameStatus::GAME_STATUS_PLAYING);
+    entry.game_status = entities::GameStatus::kPlaying;
 
     auto now = std::chrono::system_clock::now();
     entry.created_at = userver::storages::postgres::TimePointWithoutTz{ now };
@@ -71,6 +115,21 @@ entities::LibraryPostgres CreateFakeLibraryEntry(std::string_view user_id_str)
     return entry;
 }
 
+entities::LibraryChangePostgres CreateFakeLibraryChange(std::int64_t txid)
+{
+    const auto entry = CreateFakeLibraryEntry("");
+
+    entities::LibraryChangePostgres change;
+    change.txid = txid;
+    change.user_id = entry.user_id;
+    change.game_id = entry.game_id;
+    change.game_status = entities::GameStatus::kCompleted;
+    change.removed = false;
+    change.changed_at = entry.updated_at;
+
+    return change;
+}
+
 } // namespace library_service::test
 
 class LibraryServiceTest : public userver::ugrpc::tests::ServiceFixtureBase
@@ -125,7 +184,7 @@ UTEST_F(LibraryServiceTest, GetLibraryStats_EmptyUser)
 UTEST_F(LibraryServiceTest, GetLibraryStats_DbError)
 {
     ::library::GetLibraryStatsRequest request;
-    request.set_user_id("valid-uuid");
+    request.set_user_id("11111111-1111-1111-1111-111111111111");
 
     EXPECT_CALL(mock_repo_, GetLibraryStats(_))
         .WillOnce(testing::Throw(std::runtime_error("DB connection failed")));
@@ -175,7 +234,7 @@ UTEST_F(LibraryServiceTest, GetUserLibrary_FoundEntries)
 UTEST_F(LibraryServiceTest, GetUserLibrary_Empty)
 {
     ::library::GetUserLibraryRequest request;
-    request.set_user_id("valid-uuid");
+    request.set_user_id("11111111-1111-1111-1111-111111111111");
 
     EXPECT_CALL(mock_repo_, GetLibraryEntries(_, _, _))
         .WillOnce(testing::Return(std::vector<entities::LibraryPostgres>{}));
@@ -204,6 +263,49 @@ UTEST_F(LibraryServiceTest, GetUserLibrary_Validation)
     }
 }
 
+UTEST_F(LibraryServiceTest, GetUserLibrary_InvalidUuidSkipsDb)
+{
+    ::library::GetUserLibraryRequest request;
+    request.set_user_id("{22222222-2222-2222-2222-222222222222}");
+
+    EXPECT_CALL(mock_repo_, GetLibraryEntries(_, _, _)).Times(0);
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+
+    try
+    {
+        client.GetUserLibrary(request);
+        FAIL() << "Expected INVALID_ARGUMENT";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(),
+                  grpc::StatusCode::INVALID_ARGUMENT);
+    }
+}
+
+UTEST_F(LibraryServiceTest, GetUserLibrary_NegativeLimitSkipsDb)
+{
+    ::library::GetUserLibraryRequest request;
+    request.set_user_id("22222222-2222-2222-2222-222222222222");
+    request.set_limit(-1);
+
+    EXPECT_CALL(mock_repo_, GetLibraryEntries(_, _, _)).Times(0);
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+
+    try
+    {
+        client.GetUserLibrary(request);
+        FAIL() << "Expected INVALID_ARGUMENT";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(),
+                  grpc::StatusCode::INVALID_ARGUMENT);
+    }
+}
+
 UTEST_F(LibraryServiceTest, UpdateLibraryEntry_Success)
 {
     std::string user_id = "11111111-1111-1111-1111-111111111111";
@@ -217,8 +319,10 @@ UTEST_F(LibraryServiceTest, UpdateLibraryEntry_Success)
     auto success_result =
         library_service::test::CreateFakeLibraryEntry(user_id);
 
-    EXPECT_CALL(mock_repo_, CreateLibraryEntry(testing::Eq(user_id),
-                                               testing::Eq(game_id), _))
+    EXPECT_CALL(mock_repo_,
+                CreateLibraryEntry(
+                    testing::Eq(user_id), testing::Eq(game_id),
+                    testing::Eq(entities::GameStatus::kCompleted)))
         .Times(1)
         .WillOnce(testing::Return(success_result));
 
@@ -227,10 +331,80 @@ UTEST_F(LibraryServiceTest, UpdateLibraryEntry_Success)
     EXPECT_NO_THROW(client.UpdateLibraryEntry(request));
 }
 
+UTEST_F(LibraryServiceTest, UpdateLibraryEntry_MapsStatusBothWays)
+{
+    std::string user_id = "11111111-1111-1111-1111-111111111111";
+
+    ::library::UpdateLibraryEntryRequest request;
+    request.set_user_id(user_id);
+    request.set_game_id("99999999-9999-9999-9999-999999999999");
+    request.set_status(::library::GameStatus::GAME_STATUS_DROPPED);
+
+    auto db_entry = library_service::test::CreateFakeLibraryEntry(user_id);
+    db_entry.game_status = entities::GameStatus::kDropped;
+
+    EXPECT_CALL(mock_repo_,
+                CreateLibraryEntry(_, _,
+                                   testing::Eq(entities::GameStatus::kDropped)))
+        .WillOnce(testing::Return(db_entry));
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    auto response = client.UpdateLibraryEntry(request);
+
+    EXPECT_EQ(response.entry().status(),
+              ::library::GameStatus::GAME_STATUS_DROPPED);
+}
+
 UTEST_F(LibraryServiceTest, UpdateLibraryEntry_MissingFields)
 {
     ::library::UpdateLibraryEntryRequest request;
-    request.set_user_id("user-uuid");
+    request.set_user_id("11111111-1111-1111-1111-111111111111");
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+
+    try
+    {
+        client.UpdateLibraryEntry(request);
+        FAIL() << "Expected INVALID_ARGUMENT";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(),
+                  grpc::StatusCode::INVALID_ARGUMENT);
+    }
+}
+
+UTEST_F(LibraryServiceTest, UpdateLibraryEntry_InvalidUuidSkipsDb)
+{
+    ::library::UpdateLibraryEntryRequest request;
+    request.set_user_id("11111111-1111-1111-1111-111111111111");
+    request.set_game_id("99999999-9999-9999-9999-99999999999z");
+    request.set_status(::library::GameStatus::GAME_STATUS_PLAN);
+
+    EXPECT_CALL(mock_repo_, CreateLibraryEntry(_, _, _)).Times(0);
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+
+    try
+    {
+        client.UpdateLibraryEntry(request);
+        FAIL() << "Expected INVALID_ARGUMENT";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(),
+                  grpc::StatusCode::INVALID_ARGUMENT);
+    }
+}
+
+UTEST_F(LibraryServiceTest, UpdateLibraryEntry_UnknownStatusSkipsDb)
+{
+    ::library::UpdateLibraryEntryRequest request;
+    request.set_user_id("11111111-1111-1111-1111-111111111111");
+    request.set_game_id("99999999-9999-9999-9999-999999999999");
+    request.set_status(static_cast<::library::GameStatus>(12345));
+
+    EXPECT_CALL(mock_repo_, CreateLibraryEntry(_, _, _)).Times(0);
 
     auto client = MakeClient<::library::LibraryServiceClient>();
 
@@ -249,8 +423,8 @@ UTEST_F(LibraryServiceTest, UpdateLibraryEntry_MissingFields)
 UTEST_F(LibraryServiceTest, UpdateLibraryEntry_DbError)
 {
     ::library::UpdateLibraryEntryRequest request;
-    request.set_user_id("u");
-    request.set_game_id("g");
+    request.set_user_id("11111111-1111-1111-1111-111111111111");
+    request.set_game_id("99999999-9999-9999-9999-999999999999");
     request.set_status(::library::GameStatus::GAME_STATUS_PLAN);
 
     EXPECT_CALL(mock_repo_, CreateLibraryEntry(_, _, _))
@@ -268,4 +442,543 @@ UTEST_F(LibraryServiceTest, UpdateLibraryEntry_DbError)
     {
         EXPECT_EQ(e.GetStatus().error_code(), grpc::StatusCode::INTERNAL);
     }
-}
\ No newline at end of file
+}
+
+#ifdef LIBRARY_SERVICE_PROTO_V2
+UTEST_F(LibraryServiceTest, GetLibraryEntry_NotInLibrarySkipsDb)
+{
+    std::string user_id = "33333333-3333-3333-3333-333333333333";
+    std::string owned_game_id = "44444444-4444-4444-4444-444444444444";
+
+    ::library::GetLibraryEntryRequest request;
+    request.set_user_id(user_id);
+    request.set_game_id("55555555-5555-5555-5555-555555555555");
+
+    // The cold lookup is a point query, the filter is built by the refresh.
+    EXPECT_CALL(mock_repo_, GetLibraryEntry(_, _))
+        .WillOnce(testing::Return(std::nullopt));
+    EXPECT_CALL(mock_repo_, GetOutboxXmin()).WillOnce(testing::Return(10));
+    EXPECT_CALL(mock_repo_, GetLibraryGameIds(testing::Eq(user_id)))
+        .WillOnce(testing::Return(std::vector<boost::uuids::uuid>{
+            boost::uuids::string_generator()(owned_game_id) }));
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+
+    EXPECT_FALSE(client.GetLibraryEntry(request).has_entry());
+    service_.RefreshMembershipCache();
+    EXPECT_FALSE(client.GetLibraryEntry(request).has_entry());
+    EXPECT_FALSE(client.GetLibraryEntry(request).has_entry());
+}
+
+UTEST_F(LibraryServiceTest, GetLibraryEntry_Found)
+{
+    std::string user_id = "33333333-3333-3333-3333-333333333333";
+    auto db_entry = library_service::test::CreateFakeLibraryEntry(user_id);
+    std::string game_id = boost::uuids::to_string(db_entry.game_id);
+
+    ::library::GetLibraryEntryRequest request;
+    request.set_user_id(user_id);
+    request.set_game_id(game_id);
+
+    EXPECT_CALL(mock_repo_, GetLibraryGameIds(_)).Times(0);
+    EXPECT_CALL(mock_repo_,
+                GetLibraryEntry(testing::Eq(user_id), testing::Eq(game_id)))
+        .WillOnce(testing::Return(db_entry));
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    auto response = client.GetLibraryEntry(request);
+
+    ASSERT_TRUE(response.has_entry());
+    EXPECT_EQ(response.entry().game_id(), game_id);
+    EXPECT_EQ(response.entry().status(),
+              ::library::GameStatus::GAME_STATUS_PLAYING);
+}
+
+UTEST_F(LibraryServiceTest, GetLibraryEntry_UpsertUpdatesFilter)
+{
+    std::string user_id = "33333333-3333-3333-3333-333333333333";
+    auto db_entry = library_service::test::CreateFakeLibraryEntry(user_id);
+    std::string game_id = boost::uuids::to_string(db_entry.game_id);
+
+    ::library::GetLibraryEntryRequest request;
+    request.set_user_id(user_id);
+    request.set_game_id(game_id);
+
+    EXPECT_CALL(mock_repo_, GetLibraryGameIds(_))
+        .WillOnce(testing::Return(std::vector<boost::uuids::uuid>{}));
+    EXPECT_CALL(mock_repo_, CreateLibraryEntry(_, _, _))
+        .WillOnce(testing::Return(db_entry));
+    EXPECT_CALL(mock_repo_, GetLibraryEntry(_, _))
+        .WillOnce(testing::Return(std::nullopt))
+        .WillOnce(testing::Return(db_entry));
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    EXPECT_FALSE(client.GetLibraryEntry(request).has_entry());
+    service_.RefreshMembershipCache();
+    EXPECT_FALSE(client.GetLibraryEntry(request).has_entry());
+
+    ::library::UpdateLibraryEntryRequest update;
+    update.set_user_id(user_id);
+    update.set_game_id(game_id);
+    update.set_status(::library::GameStatus::GAME_STATUS_PLAYING);
+    client.UpdateLibraryEntry(update);
+
+    EXPECT_TRUE(client.GetLibraryEntry(request).has_entry());
+}
+
+UTEST_F(LibraryServiceTest, GetLibraryEntry_InvalidUuid)
+{
+    ::library::GetLibraryEntryRequest request;
+    request.set_user_id("not-a-uuid");
+    request.set_game_id("55555555-5555-5555-5555-555555555555");
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+
+    try
+    {
+        client.GetLibraryEntry(request);
+        FAIL() << "Expected INVALID_ARGUMENT";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(),
+                  grpc::StatusCode::INVALID_ARGUMENT);
+    }
+}
+
+UTEST_F(LibraryServiceTest, GetLibraryEntry_DbError)
+{
+    ::library::GetLibraryEntryRequest request;
+    request.set_user_id("33333333-3333-3333-3333-333333333333");
+    request.set_game_id("55555555-5555-5555-5555-555555555555");
+
+    EXPECT_CALL(mock_repo_, GetLibraryEntry(_, _))
+        .WillOnce(testing::Throw(std::runtime_error("DB connection failed")));
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+
+    try
+    {
+        client.GetLibraryEntry(request);
+        FAIL() << "Expected INTERNAL error";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(), grpc::StatusCode::INTERNAL);
+    }
+}
+
+UTEST_F(LibraryServiceTest, WatchLibraryChanges_StreamsAndResumes)
+{
+    ::library::WatchLibraryChangesRequest request;
+    request.set_shard(3);
+    request.set_after_offset(100);
+
+    {
+        testing::InSequence sequence;
+        EXPECT_CALL(mock_repo_,
+                    GetLibraryChanges(testing::Eq(3), testing::Eq(100), _))
+            .WillOnce(testing::Return(
+                std::vector<entities::LibraryChangePostgres>{
+                    library_service::test::CreateFakeLibraryChange(101),
+                    library_service::test::CreateFakeLibraryChange(105),
+                    library_service::test::CreateFakeLibraryChange(105) }));
+        EXPECT_CALL(mock_repo_,
+                    GetLibraryChanges(testing::Eq(3), testing::Eq(105), _))
+            .WillOnce(
+                testing::Throw(std::runtime_error("DB connection failed")));
+    }
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    auto stream = client.WatchLibraryChanges(request);
+
+    ::library::LibraryChangeEvent event;
+    ASSERT_TRUE(stream.Read(event));
+    EXPECT_EQ(event.offset(), 101);
+    EXPECT_EQ(event.status(), ::library::GameStatus::GAME_STATUS_COMPLETED);
+    ASSERT_TRUE(stream.Read(event));
+    EXPECT_EQ(event.offset(), 105);
+    // Events of one transaction share its offset.
+    ASSERT_TRUE(stream.Read(event));
+    EXPECT_EQ(event.offset(), 105);
+
+    try
+    {
+        stream.Read(event);
+        FAIL() << "Expected INTERNAL error";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(), grpc::StatusCode::INTERNAL);
+    }
+}
+
+UTEST_F(LibraryServiceTest, WatchLibraryChanges_InvalidShard)
+{
+    ::library::WatchLibraryChangesRequest request;
+    request.set_shard(-1);
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    auto stream = client.WatchLibraryChanges(request);
+
+    ::library::LibraryChangeEvent event;
+    try
+    {
+        stream.Read(event);
+        FAIL() << "Expected INVALID_ARGUMENT";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(),
+                  grpc::StatusCode::INVALID_ARGUMENT);
+    }
+}
+
+UTEST_F(LibraryServiceTest, WatchLibraryChanges_NegativeOffsetSkipsDb)
+{
+    ::library::WatchLibraryChangesRequest request;
+    request.set_shard(0);
+    request.set_after_offset(-1);
+
+    EXPECT_CALL(mock_repo_, GetLibraryChanges(_, _, _)).Times(0);
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    auto stream = client.WatchLibraryChanges(request);
+
+    ::library::LibraryChangeEvent event;
+    try
+    {
+        stream.Read(event);
+        FAIL() << "Expected INVALID_ARGUMENT";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(),
+                  grpc::StatusCode::INVALID_ARGUMENT);
+    }
+}
+
+UTEST_F(LibraryServiceTest, GetLibraryAnalytics_FromRollups)
+{
+    std::string user_id = "66666666-6666-6666-6666-666666666666";
+
+    ::library::GetLibraryAnalyticsRequest request;
+    request.set_user_id(user_id);
+
+    const auto now = userver::storages::postgres::TimePointWithoutTz{
+        std::chrono::system_clock::now()
+    };
+
+    EXPECT_CALL(mock_repo_, GetStatusCounts(testing::Eq(user_id)))
+        .WillOnce(testing::Return(std::vector<entities::StatusCountPostgres>{
+            { entities::GameStatus::kCompleted, 3 },
+            { entities::GameStatus::kPlaying, 1 } }));
+    EXPECT_CALL(mock_repo_, GetDailyActivity(testing::Eq(user_id),
+                                             testing::Eq(30)))
+        .WillOnce(
+            testing::Return(std::vector<entities::DailyActivityPostgres>{
+                { now, entities::GameStatus::kCompleted, 2 } }));
+    EXPECT_CALL(mock_repo_, GetLibraryEntries(_, _, _)).Times(0);
+    EXPECT_CALL(mock_repo_, GetLibraryStats(_)).Times(0);
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    auto response = client.GetLibraryAnalytics(request);
+
+    EXPECT_EQ(response.total_entries(), 4);
+    EXPECT_DOUBLE_EQ(response.completion_rate(), 0.75);
+    ASSERT_EQ(response.status_counts_size(), 2);
+    EXPECT_EQ(response.status_counts(0).status(),
+              ::library::GameStatus::GAME_STATUS_COMPLETED);
+    ASSERT_EQ(response.activity_size(), 1);
+    EXPECT_EQ(response.activity(0).transitions(), 2);
+}
+
+UTEST_F(LibraryServiceTest, GetLibraryAnalytics_EmptyLibrary)
+{
+    ::library::GetLibraryAnalyticsRequest request;
+    request.set_user_id("66666666-6666-6666-6666-666666666666");
+    request.set_days(7);
+
+    EXPECT_CALL(mock_repo_, GetStatusCounts(_))
+        .WillOnce(
+            testing::Return(std::vector<entities::StatusCountPostgres>{}));
+    EXPECT_CALL(mock_repo_, GetDailyActivity(_, testing::Eq(7)))
+        .WillOnce(
+            testing::Return(std::vector<entities::DailyActivityPostgres>{}));
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    auto response = client.GetLibraryAnalytics(request);
+
+    EXPECT_EQ(response.total_entries(), 0);
+    EXPECT_DOUBLE_EQ(response.completion_rate(), 0.0);
+}
+
+UTEST_F(LibraryServiceTest, GetLibraryAnalytics_InvalidDays)
+{
+    ::library::GetLibraryAnalyticsRequest request;
+    request.set_user_id("66666666-6666-6666-6666-666666666666");
+    request.set_days(1000);
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+
+    try
+    {
+        client.GetLibraryAnalytics(request);
+        FAIL() << "Expected INVALID_ARGUMENT";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(),
+                  grpc::StatusCode::INVALID_ARGUMENT);
+    }
+}
+
+UTEST_F(LibraryServiceTest, RemoveLibraryEntry_Success)
+{
+    std::string user_id = "77777777-7777-7777-7777-777777777777";
+    std::string game_id = "88888888-8888-8888-8888-888888888888";
+
+    ::library::RemoveLibraryEntryRequest request;
+    request.set_user_id(user_id);
+    request.set_game_id(game_id);
+
+    EXPECT_CALL(mock_repo_,
+                RemoveLibraryEntry(testing::Eq(user_id), testing::Eq(game_id)))
+        .WillOnce(testing::Return(true));
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    auto response = client.RemoveLibraryEntry(request);
+
+    EXPECT_TRUE(response.removed());
+}
+
+UTEST_F(LibraryServiceTest, RemoveLibraryEntry_AlreadyRemoved)
+{
+    ::library::RemoveLibraryEntryRequest request;
+    request.set_user_id("77777777-7777-7777-7777-777777777777");
+    request.set_game_id("88888888-8888-8888-8888-888888888888");
+
+    EXPECT_CALL(mock_repo_, RemoveLibraryEntry(_, _))
+        .WillOnce(testing::Return(false));
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    auto response = client.RemoveLibraryEntry(request);
+
+    EXPECT_FALSE(response.removed());
+}
+
+UTEST_F(LibraryServiceTest, RemoveLibraryEntry_InvalidUuid)
+{
+    ::library::RemoveLibraryEntryRequest request;
+    request.set_user_id("77777777-7777-7777-7777-777777777777");
+    request.set_game_id("not-a-uuid");
+
+    EXPECT_CALL(mock_repo_, RemoveLibraryEntry(_, _)).Times(0);
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+
+    try
+    {
+        client.RemoveLibraryEntry(request);
+        FAIL() << "Expected INVALID_ARGUMENT";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(),
+                  grpc::StatusCode::INVALID_ARGUMENT);
+    }
+}
+
+UTEST_F(LibraryServiceTest, PurgeUserLibrary_Success)
+{
+    std::string user_id = "77777777-7777-7777-7777-777777777777";
+
+    ::library::PurgeUserLibraryRequest request;
+    request.set_user_id(user_id);
+
+    EXPECT_CALL(mock_repo_,
+                PurgeUserLibrary(testing::Eq(user_id), testing::Eq(1000)))
+        .WillOnce(testing::Return(12));
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    auto response = client.PurgeUserLibrary(request);
+
+    EXPECT_EQ(response.removed_entries(), 12);
+}
+
+UTEST_F(LibraryServiceTest, PurgeUserLibrary_RunsBatchesUntilPartial)
+{
+    ::library::PurgeUserLibraryRequest request;
+    request.set_user_id("77777777-7777-7777-7777-777777777777");
+
+    EXPECT_CALL(mock_repo_, PurgeUserLibrary(_, testing::Eq(1000)))
+        .WillOnce(testing::Return(1000))
+        .WillOnce(testing::Return(1000))
+        .WillOnce(testing::Return(3));
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+    auto response = client.PurgeUserLibrary(request);
+
+    EXPECT_EQ(response.removed_entries(), 2003);
+}
+
+UTEST_F(LibraryServiceTest, PurgeUserLibrary_DbError)
+{
+    ::library::PurgeUserLibraryRequest request;
+    request.set_user_id("77777777-7777-7777-7777-777777777777");
+
+    EXPECT_CALL(mock_repo_, PurgeUserLibrary(_, _))
+        .WillOnce(testing::Throw(std::runtime_error("DB Connection lost")));
+
+    auto client = MakeClient<::library::LibraryServiceClient>();
+
+    try
+    {
+        client.PurgeUserLibrary(request);
+        FAIL() << "Expected INTERNAL";
+    }
+    catch (const userver::ugrpc::client::ErrorWithStatus& e)
+    {
+        EXPECT_EQ(e.GetStatus().error_code(), grpc::StatusCode::INTERNAL);
+    }
+}
+#endif
+
+UTEST(TombstoneCompactor, StopsOnPartialBatch)
+{
+    library_service::test::MockLibraryRepository repository;
+
+    library_service::TombstoneCompactionConfig config;
+    config.batch_size = 100;
+    config.batch_pause = std::chrono::milliseconds{ 0 };
+
+    EXPECT_CALL(repository,
+                DeleteTombstones(testing::Eq(std::chrono::milliseconds(
+                                     config.retention)),
+                                 testing::Eq(100)))
+        .WillOnce(testing::Return(100))
+        .WillOnce(testing::Return(100))
+        .WillOnce(testing::Return(7));
+
+    library_service::TombstoneCompactor compactor(config, repository);
+
+    EXPECT_EQ(compactor.Run(), 207);
+}
+
+UTEST(TombstoneCompactor, BoundedByMaxBatches)
+{
+    library_service::test::MockLibraryRepository repository;
+
+    library_service::TombstoneCompactionConfig config;
+    config.batch_size = 10;
+    config.max_batches = 3;
+    config.batch_pause = std::chrono::milliseconds{ 0 };
+
+    EXPECT_CALL(repository, DeleteTombstones(_, _))
+        .Times(3)
+        .WillRepeatedly(testing::Return(10));
+
+    library_service::TombstoneCompactor compactor(config, repository);
+
+    EXPECT_EQ(compactor.Run(), 30);
+}
+
+UTEST(TombstoneCompactor, PrunesOutboxAfterTombstones)
+{
+    library_service::test::MockLibraryRepository repository;
+
+    library_service::TombstoneCompactionConfig config;
+    config.batch_size = 10;
+    config.max_batches = 2;
+    config.batch_pause = std::chrono::milliseconds{ 0 };
+
+    {
+        testing::InSequence sequence;
+        EXPECT_CALL(repository, DeleteTombstones(_, testing::Eq(10)))
+            .WillOnce(testing::Return(4));
+        EXPECT_CALL(repository,
+                    DeleteLibraryChanges(
+                        testing::Eq(std::chrono::milliseconds(
+                            config.outbox_retention)),
+                        testing::Eq(10)))
+            .Times(2)
+            .WillRepeatedly(testing::Return(10));
+    }
+
+    library_service::TombstoneCompactor compactor(config, repository);
+
+    EXPECT_EQ(compactor.Run(), 24);
+}
+
+namespace {
+
+const auto kMemberUser =
+    boost::uuids::string_generator()("77777777-7777-7777-7777-777777777777");
+const auto kMemberGame =
+    boost::uuids::string_generator()("88888888-8888-8888-8888-888888888888");
+
+} // namespace
+
+UTEST(LibraryMembershipCache, OutboxEventsReachTheFilter)
+{
+    library_service::test::MockLibraryRepository repository;
+    library_service::LibraryMembershipCache cache({}, repository);
+
+    auto change = library_service::test::CreateFakeLibraryChange(12);
+    change.change_id = 40;
+    change.user_id = kMemberUser;
+    change.game_id = kMemberGame;
+
+    {
+        testing::InSequence sequence;
+        EXPECT_CALL(repository, GetOutboxXmin()).WillOnce(testing::Return(10));
+        EXPECT_CALL(repository, GetLibraryGameIds(_))
+            .WillOnce(testing::Return(std::vector<boost::uuids::uuid>{}));
+        EXPECT_CALL(repository, GetOutboxXmin()).WillOnce(testing::Return(15));
+        // Written through another instance after the build read the library.
+        EXPECT_CALL(repository, GetLibraryChangesSince(testing::Eq(10),
+                                                       testing::Eq(0), _))
+            .WillOnce(testing::Return(
+                std::vector<entities::LibraryChangePostgres>{ change }));
+    }
+
+    EXPECT_TRUE(cache.MayContain(kMemberUser, kMemberGame));
+    cache.Refresh();
+    EXPECT_FALSE(cache.MayContain(kMemberUser, kMemberGame));
+
+    cache.Refresh();
+    EXPECT_TRUE(cache.MayContain(kMemberUser, kMemberGame));
+}
+
+UTEST(LibraryMembershipCache, StaleFiltersAreNotTrusted)
+{
+    library_service::test::MockLibraryRepository repository;
+
+    library_service::MembershipCacheConfig config;
+    config.max_staleness = std::chrono::milliseconds{ 0 };
+    library_service::LibraryMembershipCache cache(config, repository);
+
+    EXPECT_CALL(repository, GetOutboxXmin()).WillOnce(testing::Return(10));
+    EXPECT_CALL(repository, GetLibraryGameIds(_))
+        .WillOnce(testing::Return(std::vector<boost::uuids::uuid>{}));
+
+    EXPECT_TRUE(cache.MayContain(kMemberUser, kMemberGame));
+    cache.Refresh();
+    EXPECT_TRUE(cache.MayContain(kMemberUser, kMemberGame));
+}
+
+UTEST(LibraryMembershipCache, FailedOutboxPassKeepsBuilding)
+{
+    library_service::test::MockLibraryRepository repository;
+    library_service::LibraryMembershipCache cache({}, repository);
+
+    EXPECT_CALL(repository, GetOutboxXmin())
+        .WillOnce(testing::Throw(std::runtime_error("DB connection failed")));
+    EXPECT_CALL(repository, GetLibraryGameIds(_))
+        .WillOnce(testing::Return(std::vector<boost::uuids::uuid>{}));
+
+    EXPECT_TRUE(cache.MayContain(kMemberUser, kMemberGame));
+    cache.Refresh();
+    // Built, but never synced with the outbox.
+    EXPECT_TRUE(cache.MayContain(kMemberUser, kMemberGame));
+}
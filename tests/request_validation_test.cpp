@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <handlers/request_validation.hpp>
+#include <structs/game_status.hpp>
+#include <tools/utils.hpp>
+#include <tools/uuid.hpp>
+
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <regex>
+#include <string>
+
+#include "uuid_generators.hpp"
+
+namespace {
+
+using library_service::test::kValidUuid;
+using library_service::test::NearUuid;
+using library_service::test::RandomUuid;
+
+constexpr int kIterations = 10000;
+
+bool IsHex(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+           (c >= 'A' && c <= 'F');
+}
+
+TEST(UuidPropertyTest, RandomUuidsRoundTripInBothCases)
+{
+    std::mt19937_64 rng(42);
+
+    for (int i = 0; i < kIterations; ++i)
+    {
+        const auto uuid = RandomUuid(rng);
+        auto text = boost::uuids::to_string(uuid);
+
+        ASSERT_TRUE(utils::IsValidUuid(text)) << text;
+        ASSERT_EQ(utils::ParseUuid(text), uuid) << text;
+
+        std::transform(text.begin(), text.end(), text.begin(),
+                       [](unsigned char c) {
+                           return static_cast<char>(std::toupper(c));
+                       });
+        ASSERT_EQ(utils::ParseUuid(text), uuid) << text;
+    }
+}
+
+TEST(UuidPropertyTest, AgreesWithReferenceRegex)
+{
+    const std::regex reference(
+        "[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-"
+        "[0-9a-fA-F]{12}");
+    std::mt19937_64 rng(7);
+
+    int valid = 0;
+    for (int i = 0; i < kIterations; ++i)
+    {
+        const auto value = NearUuid(rng);
+        const bool expected = std::regex_match(value, reference);
+
+        ASSERT_EQ(utils::IsValidUuid(value), expected) << value;
+        ASSERT_EQ(utils::ParseUuid(value).has_value(), expected) << value;
+        valid += expected;
+    }
+
+    // Both branches must actually be exercised.
+    EXPECT_GT(valid, kIterations / 20);
+    EXPECT_LT(valid, kIterations - kIterations / 20);
+}
+
+TEST(UuidPropertyTest, SingleCharacterMutationIsRejected)
+{
+    std::mt19937_64 rng(1234);
+
+    for (int i = 0; i < kIterations; ++i)
+    {
+        auto value = boost::uuids::to_string(RandomUuid(rng));
+        const auto position = rng() % value.size();
+        const bool dash = value[position] == '-';
+
+        char replacement = 0;
+        do
+        {
+            replacement = static_cast<char>(rng());
+        } while (dash ? replacement == '-' : IsHex(replacement));
+
+        value[position] = replacement;
+        ASSERT_FALSE(utils::IsValidUuid(value)) << value;
+    }
+}
+
+// Rejecting malformed input must cost the same regardless of its size:
+// no copies of the input, no work proportional to it. The allocation side
+// of this is checked in allocation_test.cpp.
+TEST(RequestValidationPropertyTest, RejectionCostIsIndependentOfInputSize)
+{
+    ::library::GetUserLibraryRequest request;
+    request.set_user_id(std::string(1 << 20, 'z'));
+
+    const auto started = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < kIterations; ++i)
+    {
+        const auto status = library_service::Validate(request);
+        ASSERT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+
+    // Copying the id even once per call would take gigabytes and seconds.
+    EXPECT_LT(elapsed, std::chrono::milliseconds(500));
+}
+
+TEST(RequestValidationPropertyTest, RejectsUnknownStatusAndNegativePaging)
+{
+    std::mt19937_64 rng(17);
+
+    for (int i = 0; i < kIterations; ++i)
+    {
+        ::library::UpdateLibraryEntryRequest update;
+        update.set_user_id(std::string(kValidUuid));
+        update.set_game_id(std::string(kValidUuid));
+        const auto status = std::uniform_int_distribution<int>(-100, 100)(rng);
+        update.set_status(static_cast<::library::GameStatus>(status));
+
+        ASSERT_EQ(library_service::Validate(update).ok(),
+                  ::library::GameStatus_IsValid(status))
+            << status;
+
+        ::library::GetUserLibraryRequest get;
+        get.set_user_id(std::string(kValidUuid));
+        get.set_limit(std::uniform_int_distribution<int>(-5, 5)(rng));
+        get.set_offset(std::uniform_int_distribution<int>(-5, 5)(rng));
+
+        ASSERT_EQ(library_service::Validate(get).ok(),
+                  get.limit() >= 0 && get.offset() >= 0);
+    }
+}
+
+#ifdef LIBRARY_SERVICE_PROTO_V2
+TEST(RequestValidationPropertyTest, RejectsNegativeShardAndOffset)
+{
+    std::mt19937_64 rng(23);
+
+    for (int i = 0; i < kIterations; ++i)
+    {
+        ::library::WatchLibraryChangesRequest watch;
+        watch.set_shard(std::uniform_int_distribution<int>(-5, 5)(rng));
+        watch.set_after_offset(
+            std::uniform_int_distribution<std::int64_t>(-5, 5)(rng));
+
+        ASSERT_EQ(library_service::Validate(watch).ok(),
+                  watch.shard() >= 0 && watch.after_offset() >= 0);
+    }
+
+    ::library::WatchLibraryChangesRequest watch;
+    watch.set_after_offset(std::numeric_limits<std::int64_t>::min());
+    EXPECT_EQ(library_service::Validate(watch).error_code(),
+              grpc::StatusCode::INVALID_ARGUMENT);
+}
+#endif
+
+} // namespace
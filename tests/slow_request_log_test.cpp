@@ -0,0 +1,86 @@
+#include <userver/utest/utest.hpp>
+
+#include <tools/slow_request_log.hpp>
+
+#include <userver/engine/sleep.hpp>
+
+namespace {
+
+utils::SlowRequestConfig SampledConfig()
+{
+    utils::SlowRequestConfig config;
+    config.enabled = true;
+    config.sample_rate = 1.0;
+    config.threshold = std::chrono::milliseconds(0);
+    return config;
+}
+
+UTEST(SlowRequestRecordTest, DisabledRecordIsNotCurrent)
+{
+    utils::SlowRequestRecord record(utils::SlowRequestConfig{}, "Rpc");
+
+    EXPECT_EQ(utils::SlowRequestRecord::Current(), nullptr);
+}
+
+UTEST(SlowRequestRecordTest, ZeroSampleRateIsNotCurrent)
+{
+    auto config = SampledConfig();
+    config.sample_rate = 0.0;
+
+    utils::SlowRequestRecord record(config, "Rpc");
+
+    EXPECT_EQ(utils::SlowRequestRecord::Current(), nullptr);
+}
+
+UTEST(SlowRequestRecordTest, UnsampledRecordIsStillTimed)
+{
+    auto config = SampledConfig();
+    config.sample_rate = 0.0;
+
+    utils::SlowRequestRecord record(config, "Rpc");
+    {
+        const auto stage = record.StartStage("db");
+        userver::engine::SleepFor(std::chrono::milliseconds(2));
+    }
+
+    // Timed, so it is logged once over the threshold, but it collects no
+    // queries.
+    EXPECT_GE(record.Elapsed(), std::chrono::milliseconds(2));
+    EXPECT_EQ(utils::SlowRequestRecord::Current(), nullptr);
+}
+
+UTEST(SlowRequestRecordTest, DisabledRecordIsNotTimed)
+{
+    utils::SlowRequestRecord record(utils::SlowRequestConfig{}, "Rpc");
+
+    EXPECT_EQ(record.Elapsed(), std::chrono::microseconds::zero());
+}
+
+UTEST(SlowRequestRecordTest, SampledRecordIsCurrentWhileAlive)
+{
+    {
+        utils::SlowRequestRecord record(SampledConfig(), "Rpc");
+        EXPECT_EQ(utils::SlowRequestRecord::Current(), &record);
+
+        {
+            const auto stage = record.StartStage("db");
+            record.AddQuery("SELECT 1", "$1=42", 1,
+                            std::chrono::microseconds(10));
+        }
+    }
+
+    EXPECT_EQ(utils::SlowRequestRecord::Current(), nullptr);
+}
+
+UTEST(SlowRequestRecordTest, NestedRecordsRestorePrevious)
+{
+    utils::SlowRequestRecord outer(SampledConfig(), "Outer");
+    {
+        utils::SlowRequestRecord inner(SampledConfig(), "Inner");
+        EXPECT_EQ(utils::SlowRequestRecord::Current(), &inner);
+    }
+
+    EXPECT_EQ(utils::SlowRequestRecord::Current(), &outer);
+}
+
+} // namespace
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <tools/topology.hpp>
+
+namespace {
+
+TEST(ComputeTopologyTest, HandlesSingleCore)
+{
+    const auto topology = utils::ComputeTopology(1);
+
+    EXPECT_EQ(topology.grpc_completion_queues, 1u);
+    EXPECT_EQ(topology.grpc_worker_threads, 1u);
+    EXPECT_EQ(topology.main_worker_threads, 1u);
+}
+
+TEST(ComputeTopologyTest, TreatsZeroCoresAsOne)
+{
+    const auto topology = utils::ComputeTopology(0);
+
+    EXPECT_EQ(topology.grpc_completion_queues, 1u);
+    EXPECT_EQ(topology.grpc_worker_threads, 1u);
+    EXPECT_EQ(topology.main_worker_threads, 1u);
+}
+
+TEST(ComputeTopologyTest, SplitsCoresBetweenQueuesAndWorkers)
+{
+    const auto topology = utils::ComputeTopology(16);
+
+    EXPECT_EQ(topology.grpc_completion_queues, 4u);
+    EXPECT_EQ(topology.grpc_worker_threads, 11u);
+    EXPECT_EQ(topology.main_worker_threads, 1u);
+}
+
+TEST(ComputeTopologyTest, NeverOversubscribes)
+{
+    auto previous = utils::ComputeTopology(3);
+
+    for (std::size_t cores = 4; cores <= 256; ++cores)
+    {
+        const auto topology = utils::ComputeTopology(cores);
+
+        EXPECT_GE(topology.grpc_completion_queues,
+                  previous.grpc_completion_queues);
+        EXPECT_GE(topology.grpc_worker_threads, previous.grpc_worker_threads);
+        EXPECT_EQ(topology.grpc_completion_queues +
+                      topology.grpc_worker_threads +
+                      topology.main_worker_threads,
+                  cores)
+            << "cores: " << cores;
+
+        previous = topology;
+    }
+}
+
+TEST(CpuQuotaTest, ParsesCgroupV2CpuMax)
+{
+    EXPECT_EQ(utils::ParseCgroupCpuMax("400000 100000\n"), 4u);
+    EXPECT_EQ(utils::ParseCgroupCpuMax("250000 100000"), 2u);
+    EXPECT_EQ(utils::ParseCgroupCpuMax("50000 100000"), 1u);
+    EXPECT_EQ(utils::ParseCgroupCpuMax("max 100000\n"), std::nullopt);
+    EXPECT_EQ(utils::ParseCgroupCpuMax(""), std::nullopt);
+    EXPECT_EQ(utils::ParseCgroupCpuMax("4x 100000"), std::nullopt);
+}
+
+TEST(CpuQuotaTest, ParsesCgroupV1Quota)
+{
+    EXPECT_EQ(utils::CpuQuotaCores(200000, 100000), 2u);
+    EXPECT_EQ(utils::CpuQuotaCores(-1, 100000), std::nullopt);
+    EXPECT_EQ(utils::CpuQuotaCores(100000, 0), std::nullopt);
+}
+
+TEST(CpuQuotaTest, QuotaCapsAffinity)
+{
+    // A pod limited to 4 CPUs on a 64-core node.
+    EXPECT_EQ(utils::CapByCpuQuota(64, 4u), 4u);
+    EXPECT_EQ(utils::ComputeTopology(utils::CapByCpuQuota(64, 4u))
+                  .grpc_worker_threads,
+              2u);
+
+    // taskset narrower than the quota.
+    EXPECT_EQ(utils::CapByCpuQuota(2, 8u), 2u);
+    EXPECT_EQ(utils::CapByCpuQuota(16, std::nullopt), 16u);
+}
+
+TEST(CpuQuotaTest, DetectsAtLeastOneCore)
+{
+    EXPECT_GE(utils::DetectAvailableCores(), 1u);
+}
+
+} // namespace
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <structs/game_status.hpp>
 #include <tools/utils.hpp>
 
 #include <userver/storages/postgres/io/chrono.hpp>
@@ -93,4 +94,25 @@ TEST(GameStatusToStringTest, HandlesZeroValue)
     EXPECT_FALSE(result.empty());
 }
 
+TEST(GameStatusMappingTest, RoundTripsEveryStatus)
+{
+    for (const auto& mapping : entities::kGameStatusMappings)
+    {
+        EXPECT_EQ(entities::ToProto(mapping.entity), mapping.proto);
+        EXPECT_EQ(entities::FromProto(mapping.proto), mapping.entity);
+        EXPECT_EQ(entities::ToDbName(mapping.entity), mapping.db_name);
+        EXPECT_EQ(utils::GameStatusToString(mapping.proto), mapping.db_name);
+        EXPECT_EQ(entities::kGameStatusDbNames.TryFindByFirst(mapping.db_name),
+                  mapping.entity);
+        EXPECT_EQ(entities::kGameStatusDbNames.TryFindBySecond(mapping.entity),
+                  mapping.db_name);
+    }
+}
+
+TEST(GameStatusMappingTest, UnknownProtoValueIsUnspecified)
+{
+    EXPECT_EQ(entities::FromProto(static_cast<::library::GameStatus>(12345)),
+              entities::GameStatus::kUnspecified);
+}
+
 } // namespace
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <boost/uuid/uuid.hpp>
+
+// Random inputs shared by the property tests and the allocation tests.
+namespace library_service::test {
+
+inline constexpr std::string_view kValidUuid =
+    "123e4567-e89b-42d3-a456-426614174000";
+
+inline boost::uuids::uuid RandomUuid(std::mt19937_64& rng)
+{
+    boost::uuids::uuid uuid{};
+    for (auto& byte : uuid.data)
+        byte = static_cast<std::uint8_t>(rng());
+
+    return uuid;
+}
+
+// Strings drawn mostly from the uuid alphabet, so that a good share of
+// them is valid or one character away from valid.
+inline std::string NearUuid(std::mt19937_64& rng)
+{
+    static constexpr std::string_view kAlphabet = "0123456789abcdefABCDEF-g{ ";
+
+    std::string value(kValidUuid);
+    value.resize(std::uniform_int_distribution<std::size_t>(34, 38)(rng), '0');
+
+    const auto mutations = std::uniform_int_distribution<int>(0, 3)(rng);
+    for (int i = 0; i < mutations; ++i)
+    {
+        value[rng() % value.size()] = kAlphabet[rng() % kAlphabet.size()];
+    }
+
+    return value;
+}
+
+} // namespace library_service::test